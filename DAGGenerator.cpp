@@ -0,0 +1,329 @@
+//
+//  DAGGenerator.cpp
+//  algorithm_proj3
+//
+//  Writes random process graphs in the input format of EE360CProject3 and
+//  MinimizeTotalTardiness: the number of processes, then "id time {deps}"
+//  records. Every dependency is on a lower ID, so the graphs have no cycle,
+//  and every record is worked out from its ID and the random stream alone,
+//  so 10^8 processes take no more memory than 10^3.
+//
+//  usage: DAGGenerator SHAPE PROCESSES [options]
+//  shapes:
+//    chain      each process depends on the one before
+//    layered    layers of --width processes, each depending on --fanin
+//               processes of the layer before
+//    forkjoin   a process forks --width processes, which all join into the
+//               next one, over and over
+//    random     Erdos-Renyi: every pair depends with the same probability,
+//               --degree dependencies per process on average
+//    workflow   stages like a Montage mosaic: --width projections, a
+//               difference of each neighbouring pair, one fit of all of the
+//               differences, a correction of each projection by the fit, and
+//               one sum of all of the corrections, which the next stage's
+//               projections depend on
+//  options:
+//    --seed S        the same seed always gives the same file, 1 by default
+//    --max-time T    execution times are 1 to T, 20 by default
+//    --max-cost C    give each dependency a transfer cost of 0 to C, "{2:5}"
+//    --width W       see the shapes; the square root of PROCESSES for
+//                    layered, 8 for forkjoin and workflow
+//    --fanin F       3 by default
+//    --degree D      3 by default
+//    --out FILE      instead of stdout
+//
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+
+using namespace std;
+
+/*
+ * splitmix64, written out instead of mt19937 and the <random> distributions,
+ * whose output isn't the same from one standard library to another
+ */
+class Random {
+    uint64_t state;
+public:
+    Random(uint64_t seed) : state(seed) {}
+    uint64_t Next(void) {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+    //low to high, both included
+    long long Uniform(long long low, long long high) {
+        return low + (long long)(Next() % (uint64_t)(high - low + 1));
+    }
+};
+
+/*
+ * How many trials fail before one succeeds, each succeeding with
+ * probability p; cap or more comes out as cap. Not log(u) / log(1 - p),
+ * which can round differently from one libm to another. The binary digits
+ * of such a count are independent, digit i being 1 with probability
+ * r / (1 + r) where r = (1 - p)^(2^i), so every digit below cap is one
+ * comparison with a 32 bit threshold, two digits to a Next(), and one more
+ * comparison says whether the count reaches cap at all. The thresholds
+ * only take multiplication, addition and division, which IEEE 754 rounds
+ * the same everywhere.
+ */
+class GeometricSkip {
+    vector<uint32_t> digit = vector<uint32_t>{};
+    uint64_t beyond;  //cap or more
+    long long cap;
+public:
+    GeometricSkip(double p, long long cap) : cap(cap) {
+        double r = 1 - p;
+        for (long long reach = 1; reach < cap; reach *= 2) {
+            double t = r / (1 + r);
+            digit.push_back(t >= 1 ? numeric_limits<uint32_t>::max() : (uint32_t)(t * 4294967296.0));
+            r *= r;
+        }
+        beyond = r >= 1 ? numeric_limits<uint64_t>::max() : (uint64_t)(r * 18446744073709551616.0);
+    }
+    long long Next(Random& rng) const {
+        if (rng.Next() < beyond) {
+            return cap;
+        }
+        //the digits are coin flips, so no branches on them
+        long long count = 0;
+        size_t i = 0;
+        for (; i + 1 < digit.size(); i += 2) {
+            uint64_t bits = rng.Next();
+            count |= (long long)((uint32_t)bits < digit[i]) << i;
+            count |= (long long)((uint32_t)(bits >> 32) < digit[i + 1]) << (i + 1);
+        }
+        if (i < digit.size()) {
+            count |= (long long)((uint32_t)rng.Next() < digit[i]) << i;
+        }
+        return min(count, cap);
+    }
+};
+
+struct Options {
+    string shape;
+    long long processes = 0;
+    uint64_t seed = 1;
+    int max_time = 20;
+    int max_cost = 0;
+    long long width = 0;
+    int fanin = 3;
+    double degree = 3;
+    string out;
+};
+
+//buffered so writing 10^8 records is bounded by the disk, not by stdio
+class Writer {
+    FILE* out;
+    vector<char> buffer = vector<char>(1 << 20);
+    size_t used = 0;
+public:
+    Writer(FILE* out) : out(out) {}
+    ~Writer(void) {
+        Flush();
+    }
+    void Flush(void) {
+        fwrite(buffer.data(), 1, used, out);
+        used = 0;
+    }
+    void Char(char c) {
+        if (used == buffer.size()) {
+            Flush();
+        }
+        buffer[used++] = c;
+    }
+    void Int(long long value) {
+        char digits[24];
+        int k = 0;
+        do {
+            digits[k++] = (char)('0' + value % 10);
+            value /= 10;
+        } while (value > 0);
+        while (k > 0) {
+            Char(digits[--k]);
+        }
+    }
+};
+
+//the chance of each dependency in the random shape
+double RandomProbability(const Options& o) {
+    return min(1.0, 2 * o.degree / max<long long>(1, o.processes - 1));
+}
+
+/*
+ * The dependencies of process id, for each shape. k is id - 1, so the
+ * formulas can count from 0.
+ */
+void Dependencies(const Options& o, long long id, Random& rng, const GeometricSkip& skip, vector<long long>& depend) {
+    depend.clear();
+    long long k = id - 1;
+    long long w = o.width;
+    if (o.shape == "chain") {
+        if (id > 1) {
+            depend.push_back(id - 1);
+        }
+    } else if (o.shape == "layered") {
+        long long layer = k / w;
+        if (layer > 0) {
+            long long first = (layer - 1) * w + 1;
+            int fanin = (int)min<long long>(o.fanin, w);
+            while ((int)depend.size() < fanin) {
+                long long j = first + rng.Uniform(0, w - 1);
+                if (find(depend.begin(), depend.end(), j) == depend.end()) {
+                    depend.push_back(j);
+                }
+            }
+            sort(depend.begin(), depend.end());
+        }
+    } else if (o.shape == "forkjoin") {
+        //process 1 forks, then blocks of w branches and the join of them
+        if (k > 0) {
+            long long block = (k - 1) / (w + 1), position = (k - 1) % (w + 1);
+            long long fork = block * (w + 1) + 1;
+            if (position < w) {
+                depend.push_back(fork);
+            } else {
+                for (long long j = 1; j <= w; ++j) {
+                    depend.push_back(fork + j);
+                }
+            }
+        }
+    } else if (o.shape == "random") {
+        //each lower ID with probability p, skipping ahead geometrically instead of trying every one
+        if (RandomProbability(o) >= 1) {
+            for (long long j = 1; j < id; ++j) {
+                depend.push_back(j);
+            }
+        } else {
+            for (long long j = id - 1; ; --j) {
+                j -= skip.Next(rng);
+                if (j < 1) {
+                    break;
+                }
+                depend.push_back(j);
+            }
+            reverse(depend.begin(), depend.end());
+        }
+    } else {
+        //workflow: stages of w projections, w - 1 differences, a fit, w corrections and a sum
+        long long stage = k / (3 * w + 1), position = k % (3 * w + 1);
+        long long base = stage * (3 * w + 1);  //the ID of the last stage's sum, 0 for the first stage
+        if (position < w) {
+            if (stage > 0) {
+                depend.push_back(base);
+            }
+        } else if (position < 2 * w - 1) {
+            long long d = position - w;
+            depend.push_back(base + d + 1);
+            depend.push_back(base + d + 2);
+        } else if (position == 2 * w - 1) {
+            for (long long d = 0; d < w - 1; ++d) {
+                depend.push_back(base + w + d + 1);
+            }
+        } else if (position < 3 * w) {
+            long long c = position - 2 * w;
+            depend.push_back(base + c + 1);
+            depend.push_back(base + 2 * w);
+        } else {
+            for (long long c = 0; c < w; ++c) {
+                depend.push_back(base + 2 * w + c + 1);
+            }
+        }
+    }
+}
+
+int main(int argc, const char * argv[]) {
+    Options o;
+    if (argc < 3) {
+        cerr << "usage: DAGGenerator chain|layered|forkjoin|random|workflow PROCESSES [options]" << endl;
+        return 1;
+    }
+    o.shape = argv[1];
+    o.processes = atoll(argv[2]);
+    for (int a = 3; a < argc; ++a) {
+        string flag = argv[a];
+        if (a + 1 >= argc) {
+            cerr << "no value for " << flag << endl;
+            return 1;
+        }
+        const char* value = argv[++a];
+        if (flag == "--seed") {
+            o.seed = strtoull(value, nullptr, 10);
+        } else if (flag == "--max-time") {
+            o.max_time = max(1, atoi(value));
+        } else if (flag == "--max-cost") {
+            o.max_cost = max(0, atoi(value));
+        } else if (flag == "--width") {
+            o.width = atoll(value);
+        } else if (flag == "--fanin") {
+            o.fanin = max(1, atoi(value));
+        } else if (flag == "--degree") {
+            o.degree = max(0.0, atof(value));
+        } else if (flag == "--out") {
+            o.out = value;
+        } else {
+            cerr << "unknown option " << flag << endl;
+            return 1;
+        }
+    }
+    if (o.shape != "chain" && o.shape != "layered" && o.shape != "forkjoin"
+        && o.shape != "random" && o.shape != "workflow") {
+        cerr << "unknown shape " << o.shape << endl;
+        return 1;
+    }
+    if (o.processes < 0 || o.processes > numeric_limits<int>::max()) {
+        cerr << "the readers take up to " << numeric_limits<int>::max() << " processes" << endl;
+        return 1;
+    }
+    if (o.width <= 0) {
+        o.width = o.shape == "layered" ? max(1ll, (long long)sqrt((double)o.processes)) : 8;
+    }
+    o.width = o.shape == "workflow" ? max(2ll, o.width) : max(1ll, o.width);
+
+    FILE* out = o.out.empty() ? stdout : fopen(o.out.c_str(), "wb");
+    if (out == nullptr) {
+        cerr << "can't write " << o.out << endl;
+        return 1;
+    }
+    {
+        Writer w(out);
+        Random rng(o.seed);
+        GeometricSkip skip(RandomProbability(o), max(1ll, o.processes));
+        vector<long long> depend;
+        w.Int(o.processes);
+        w.Char('\n');
+        for (long long id = 1; id <= o.processes; ++id) {
+            Dependencies(o, id, rng, skip, depend);
+            w.Int(id);
+            w.Char(' ');
+            w.Int(rng.Uniform(1, o.max_time));
+            w.Char(' ');
+            w.Char('{');
+            for (size_t j = 0; j < depend.size(); ++j) {
+                if (j > 0) {
+                    w.Char(',');
+                }
+                w.Int(depend[j]);
+                if (o.max_cost > 0) {
+                    w.Char(':');
+                    w.Int(rng.Uniform(0, o.max_cost));
+                }
+            }
+            w.Char('}');
+            w.Char('\n');
+        }
+    }
+    if (out != stdout) {
+        fclose(out);
+    }
+    return 0;
+}
@@ -15,49 +15,96 @@
 #include <fstream>
 #include <string>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <queue>
+#include <random>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include "GraphInput.h"
+#include "ReadyQueue.h"
 
 using namespace std;
 enum Color{ White, Gray, Black};
+/*
+ * What scheduling reads and writes. The DFS marks, which only the cycle
+ * check uses, are in Graph::visit, and the scheduler's own lists hold IDs or
+ * Candidates (ReadyQueue.h), so they don't drag whole Processes through the
+ * cache.
+ */
 struct Process {
     int processID;
     int execution_time;
     int start;
     int finish;
-    vector<int> depend_list;
-    vector<int> adj_list;
+    //where the dependency and dependent IDs are in Graph::adjacency
+    int depend_offset;
+    int depend_count;
+    int adj_offset;
+    int adj_count;
+    int depend_weight;
+    int processorID;
+};
+
+//DFS discovery and finish times
+struct Visit {
     Color color;
     int d;
     int f;
-    int depend_weight;
-    int processorID;
 };
 
 struct Processor {
     int processorID;
     bool busy;
-    vector<Process> scheduled_process = vector<Process>{};
+    vector<int> scheduled_process = vector<int>{};  //IDs, in start order
 };
-struct CompareWeight{
-    bool operator()(const Process& left, const Process& right) {
-        if (left.depend_weight > right.depend_weight) {
-            return true;
-        } else if (left.depend_weight == right.depend_weight) {
-            if (left.execution_time >= right.execution_time) {
-                return true;
-            } else {
-                return false;
-            }
-        } else {
-            return false;
-        }
-    }
+
+//what the metrics report says about one task
+struct TaskMetrics {
+    int processID;
+    int processorID;
+    int start;
+    int finish;
+    int ready;  //when the last dependency's output was on the processor
+    int wait;   //start - ready, time spent waiting for a processor
 };
 
-struct CompareID{
-    bool operator()(const Process& left, const Process& right) {
-        return left.processID < right.processID;
-    }
+struct ProcessorMetrics {
+    int processorID;
+    int busy_time;
+    double utilization;  //busy_time / makespan
+    vector<pair<int, int> > idle_gaps = vector<pair<int, int> >{};  //[from, to)
+};
+
+struct ScheduleMetrics {
+    int makespan;
+    int critical_path;  //longest dependency chain, a lower bound on any makespan
+    double makespan_ratio;  //makespan / critical_path, 1 is as good as it gets
+    vector<ProcessorMetrics> processors = vector<ProcessorMetrics>{};
+    vector<TaskMetrics> tasks = vector<TaskMetrics>{};  //in start order
 };
+
+//no schedule on processor_vec.size() processors can finish before value
+struct LowerBound {
+    int critical_path;  //longest dependency chain
+    int work;           //total execution time over the processors, rounded up
+    int value;          //the larger of the two
+};
+
+//a run of IDs in Graph::adjacency, for range for
+struct IDRange {
+    const int* first;
+    const int* last;
+    const int* begin(void) const { return first; }
+    const int* end(void) const { return last; }
+    size_t size(void) const { return last - first; }
+};
+
 struct CompareStart{
     bool operator()(const Process& left, const Process& right) {
         return left.start < right.start;
@@ -71,105 +118,293 @@ public:
     int time;
     int vertex_number;
     vector<Process> process_vec;
+    vector<Visit> visit = vector<Visit>{};  //by ID - 1
     bool has_cycle = false;
-    vector<Process> candidate = vector<Process>{};
-    vector<Process> unscheduled_process = vector<Process>{};
+    ReadyQueue candidate = ReadyQueue{};
+    vector<Candidate> deferred = vector<Candidate>{};  //candidates waiting for a transfer this step
     vector<Processor> processor_vec = vector<Processor>{};
-    vector<Process> in_processor = vector<Process>{};
+    vector<int> in_processor = vector<int>{};  //IDs
+    vector<pair<int, int> > dfs_stack = vector<pair<int, int> >{};  //(ID, dependents visited so far)
+    vector<int> path_mark = vector<int>{};  //Find_Path's visited marks, by ID - 1
+    int path_stamp = 0;
+    /*
+     * Every process's dependencies, in input order, then every process's
+     * dependents, each process's in one run (see Process). Reading appends
+     * the dependencies; ConstructGraph counts the dependents of each process
+     * first and then fills them in, so the whole graph is one allocation.
+     */
+    vector<int> adjacency = vector<int>{};
+    //transfer cost of each dependency in adjacency, when it runs on another processor
+    vector<int> cost = vector<int>{};
+    bool has_costs = false;
+    vector<int> waiting = vector<int>{};  //dependencies still running or unscheduled, by ID - 1
 public:
-    void FindCandidate(void) {
-        for (auto i = unscheduled_process.begin(); i < unscheduled_process.end(); ++i) {
-            if (i->depend_list.size() == 0) {
-                candidate.push_back(*i);
-            }
+    IDRange DependList(const Process& u) {
+        const int* first = adjacency.data() + u.depend_offset;
+        return IDRange{first, first + u.depend_count};
+    }
+    IDRange AdjList(const Process& u) {
+        const int* first = adjacency.data() + u.adj_offset;
+        return IDRange{first, first + u.adj_count};
+    }
+    //when the outputs of all of u's dependencies can be on processor p
+    int DataReady(const Process& u, int p) {
+        int ready = 0;
+        const int* c = cost.data() + u.depend_offset;
+        for (auto j : DependList(u)) {
+            const Process& v = process_vec[j - 1];
+            ready = max(ready, v.finish + (v.processorID != p ? *c : 0));
+            ++c;
         }
-        for (auto &i : candidate) {
-            for (auto j = unscheduled_process.begin(); j < unscheduled_process.end(); ++j) {
-                if (i.processID == j->processID) {
-                    Find_Path(*j);
-                    i.depend_weight = j->depend_weight;
+        return ready;
+    }
+    //u's last dependency finished
+    void AddCandidate(const Process& u) {
+        candidate.push(Candidate{u.processID, u.execution_time, Find_Path(u)});
+    }
+    //depend_weight is the total execution time of u and of everything that
+    //depends on it, directly or not. All of those are still unscheduled, so
+    //the walk is over the whole graph. The original walked the shrinking
+    //unscheduled list by ID, so once anything was scheduled it summed other
+    //processes than these, or read past the end of the list; T3 changes on
+    //most graphs, mostly for the better
+    int Find_Path(const Process& u) {
+        if (path_mark.size() != process_vec.size()) {
+            path_mark.assign(process_vec.size(), 0);
+        }
+        ++path_stamp;
+        int depend_weight = 0;
+        vector<int> to_visit{u.processID};
+        path_mark[u.processID - 1] = path_stamp;
+        while (!to_visit.empty()) {
+            const Process& v = process_vec[to_visit.back() - 1];
+            to_visit.pop_back();
+            depend_weight += v.execution_time;
+            for (auto i : AdjList(v)) {
+                if (path_mark[i - 1] != path_stamp) {
+                    path_mark[i - 1] = path_stamp;
+                    to_visit.push_back(i);
                 }
             }
         }
-        for (auto i : candidate) {
-            for (auto j = unscheduled_process.begin(); j < unscheduled_process.end(); ++j) {
-                if (j->processID == i.processID) {
-                    unscheduled_process.erase(j);
-                    --j;
+        return depend_weight;
+    }
+    //with its own stack, so a chain of millions of processes can't overflow the call stack
+    void DFS_Visit(const Process& root) {
+        ++time;
+        visit[root.processID - 1] = Visit{Gray, time, 0};
+        dfs_stack.push_back(make_pair(root.processID, 0));
+        while (!dfs_stack.empty()) {
+            const Process& u = process_vec[dfs_stack.back().first - 1];
+            if (dfs_stack.back().second < u.adj_count) {
+                int i = adjacency[u.adj_offset + dfs_stack.back().second++];
+                if (visit[i - 1].color == White) {
+                    ++time;
+                    visit[i - 1] = Visit{Gray, time, 0};
+                    dfs_stack.push_back(make_pair(i, 0));
+                } else if (visit[i - 1].color == Gray) {
+                    has_cycle = true;
                 }
+            } else {
+                ++time;
+                visit[u.processID - 1].color = Black;
+                visit[u.processID - 1].f = time;
+                dfs_stack.pop_back();
             }
         }
-        if (baseline) {
-            sort(candidate.begin(), candidate.end(), CompareID());
-        } else {
-            sort(candidate.begin(), candidate.end(), CompareWeight());
-        }
     }
-    void Find_Path_Visit(Process& u) {
-        u.color = Gray;
-        for (auto i : u.adj_list) {
-            if (unscheduled_process[i - 1].color == White) {
-                Find_Path_Visit(unscheduled_process[i -1]);
+    void DFS(void) {
+        visit.assign(process_vec.size(), Visit{White, 0, 0});
+        time = 0;
+        for (auto &u : process_vec) {
+            if (visit[u.processID - 1].color == White) {
+                DFS_Visit(u);
             }
         }
-        u.color = Black;
     }
-    void Find_Path(Process& u) {
-        for (auto &i : unscheduled_process) {
-            i.color = White;
+    //IDs in topological order, by decreasing DFS finish time (DFS must have run)
+    vector<int> TopologicalOrder(void) {
+        vector<int> by_finish(2 * process_vec.size() + 1, 0);
+        for (auto &i : process_vec) {
+            by_finish[visit[i.processID - 1].f] = i.processID;
         }
-        u.depend_weight = 0;
-        Find_Path_Visit(u);
-        for (auto i : unscheduled_process) {
-            if (i.color == Black) {
-                u.depend_weight += i.execution_time;
+        vector<int> order;
+        order.reserve(process_vec.size());
+        for (size_t f = by_finish.size(); f-- > 0;) {
+            if (by_finish[f] != 0) {
+                order.push_back(by_finish[f]);
             }
         }
+        return order;
     }
-    void DFS_Visit(Process& u) {
-        ++time;
-        u.d = time;
-        u.color = Gray;
-        for (auto i : u.adj_list) {
-            if (process_vec[i - 1].color == White) {
-                DFS_Visit(process_vec[i - 1]);
-            } else if (process_vec[i - 1].color == Gray) {
-                has_cycle = true;
+    //the longest chain that starts with each process, by ID - 1
+    vector<int> ChainTails(void) {
+        vector<int> tail(process_vec.size(), 0);
+        vector<int> order = TopologicalOrder();
+        for (auto id = order.rbegin(); id != order.rend(); ++id) {
+            const Process& u = process_vec[*id - 1];
+            int longest = 0;
+            for (auto i : AdjList(u)) {
+                longest = max(longest, tail[i - 1]);
             }
+            tail[*id - 1] = longest + u.execution_time;
         }
-        u.color = Black;
-        ++time;
-        u.f = time;
+        return tail;
     }
-    void DFS(void) {
+    LowerBound ComputeLowerBound(void) {
+        LowerBound b;
+        vector<int> tail = ChainTails();
+        b.critical_path = tail.empty() ? 0 : *max_element(tail.begin(), tail.end());
+        long long total = 0;
         for (auto &i : process_vec) {
-            i.color = White;
+            total += i.execution_time;
         }
-        time = 0;
-        for (auto &u : process_vec) {
-            if (u.color == White) {
-                DFS_Visit(u);
+        int processors = (int)processor_vec.size();
+        b.work = (int)((total + processors - 1) / processors);
+        b.value = max(b.critical_path, b.work);
+        return b;
+    }
+    //IDs in start order (ties by ID), merged from the processors' lists,
+    //which schedule() already fills in start order
+    vector<int> ScheduleOrder(void) {
+        vector<int> order;
+        order.reserve(process_vec.size());
+        vector<size_t> next(processor_vec.size(), 0);
+        while (true) {
+            const Process* first = nullptr;
+            int from = -1;
+            for (int k = 0; k < (int)processor_vec.size(); ++k) {
+                if (next[k] == processor_vec[k].scheduled_process.size()) {
+                    continue;
+                }
+                const Process& p = process_vec[processor_vec[k].scheduled_process[next[k]] - 1];
+                if (first == nullptr || p.start < first->start
+                    || (p.start == first->start && p.processID < first->processID)) {
+                    first = &p;
+                    from = k;
+                }
+            }
+            if (first == nullptr) {
+                break;
+            }
+            order.push_back(first->processID);
+            ++next[from];
+        }
+        return order;
+    }
+    //one pass over the finished schedule, in start order
+    ScheduleMetrics ComputeMetrics(void) {
+        ScheduleMetrics m;
+        m.makespan = timestamp;
+        for (auto &i : processor_vec) {
+            ProcessorMetrics pm;
+            pm.processorID = i.processorID;
+            pm.busy_time = 0;
+            pm.utilization = 0;
+            m.processors.push_back(pm);
+        }
+        //not from the start order, which isn't topological once a dependency
+        //takes no time and starts with its dependent
+        if (visit.size() != process_vec.size()) {
+            DFS();
+        }
+        m.critical_path = ComputeLowerBound().critical_path;
+        vector<int> last_finish(processor_vec.size(), 0);
+        for (auto id : ScheduleOrder()) {
+            const Process& u = process_vec[id - 1];
+            TaskMetrics t;
+            t.processID = id;
+            t.processorID = u.processorID;
+            t.start = u.start;
+            t.finish = u.finish;
+            t.ready = DataReady(u, u.processorID);
+            t.wait = u.start - t.ready;
+
+            ProcessorMetrics& pm = m.processors[u.processorID];
+            pm.busy_time += u.execution_time;
+            if (u.start > last_finish[u.processorID]) {
+                pm.idle_gaps.push_back(make_pair(last_finish[u.processorID], u.start));
+            }
+            last_finish[u.processorID] = u.finish;
+            m.tasks.push_back(t);
+        }
+        for (auto &pm : m.processors) {
+            if (m.makespan > last_finish[pm.processorID]) {
+                pm.idle_gaps.push_back(make_pair(last_finish[pm.processorID], m.makespan));
             }
+            pm.utilization = m.makespan > 0 ? (double)pm.busy_time / m.makespan : 0;
         }
+        m.makespan_ratio = m.critical_path > 0 ? (double)m.makespan / m.critical_path : 1;
+        return m;
     }
     void PrintProcess() {
-        vector<Process> temp = process_vec;
-        sort(temp.begin(), temp.end(), CompareStart());
-        for (auto i : temp) {
+        for (auto id : ScheduleOrder()) {
+            const Process& i = process_vec[id - 1];
             cout << "ID:" << i.processID << " Start:" << i.start << " Finish:" << i.finish << " Processor ID:" << i.processorID << endl;
         }
     }
+    //replace the schedule with one built elsewhere; order lists IDs so that
+    //each processor's processes come in start order
+    void ApplySchedule(const vector<int>& order, const vector<int>& start, const vector<int>& processor) {
+        timestamp = 0;
+        for (auto &i : processor_vec) {
+            i.scheduled_process.clear();
+        }
+        for (auto id : order) {
+            Process& u = process_vec[id - 1];
+            u.start = start[id - 1];
+            u.finish = u.start + u.execution_time;
+            u.processorID = processor[id - 1];
+            processor_vec[u.processorID].scheduled_process.push_back(id);
+            timestamp = max(timestamp, u.finish);
+        }
+    }
+    //back to an empty graph, keeping every buffer for the next one
+    void Reset(void) {
+        baseline = false;
+        timestamp = 0;
+        has_cycle = false;
+        process_vec.clear();
+        candidate.clear();
+        processor_vec.clear();
+        in_processor.clear();
+        adjacency.clear();
+        cost.clear();
+        has_costs = false;
+    }
+    //process_vec and the dependencies in adjacency are read; adds the dependents
     void ConstructGraph(void) {
-        for (auto i : process_vec) {
-            for (auto j : i.depend_list) {
-                process_vec[j - 1].adj_list.push_back(i.processID);
+        int dependencies = (int)adjacency.size();
+        cost.resize(dependencies, 0); //no costs were read: every transfer is free
+        has_costs = any_of(cost.begin(), cost.end(), [](int c) { return c != 0; });
+        //count, then make room for each process's dependents right after the dependencies
+        for (auto &i : process_vec) {
+            i.adj_count = 0;
+        }
+        for (int k = 0; k < dependencies; ++k) {
+            ++process_vec[adjacency[k] - 1].adj_count;
+        }
+        int offset = dependencies;
+        for (auto &i : process_vec) {
+            i.adj_offset = offset;
+            offset += i.adj_count;
+            i.adj_count = 0;
+        }
+        adjacency.resize(offset);
+        waiting.resize(process_vec.size());
+        for (auto &i : process_vec) {
+            for (int k = i.depend_offset; k < i.depend_offset + i.depend_count; ++k) {
+                Process& v = process_vec[adjacency[k] - 1];
+                adjacency[v.adj_offset + v.adj_count++] = i.processID;
             }
+            waiting[i.processID - 1] = i.depend_count;
         }
         for (auto &i : process_vec) {
             i.start = 0;
             i.finish = i.execution_time;
+            i.depend_weight = 0;
+            i.processorID = 0;
         }
-        unscheduled_process = process_vec;
         for (int i = 0; i < 3; ++i) {
             Processor p;
             p.processorID = i;
@@ -180,104 +415,973 @@ public:
     void ShowDependList(void) {
         for (auto i : process_vec) {
             cout << "ID:" << i.processID << " ";
-            for (auto j : i.depend_list) {
+            for (auto j : DependList(i)) {
                 cout << j << " ";
             }
             cout << endl;
         }
     }
+    /*
+     * Runs from event to event: a process finishing, or a waiting transfer
+     * arriving. Nothing changes in between, so the steps in between are
+     * skipped instead of scanned.
+     */
     void schedule() {
         timestamp = 0;
-        while (unscheduled_process.size() != 0 || in_processor.size() != 0) {
+        candidate.by_id = baseline;
+        for (auto &i : process_vec) {
+            if (waiting[i.processID - 1] == 0) {
+                AddCandidate(i);
+            }
+        }
+        while (true) {
             for (auto i = in_processor.begin(); i < in_processor.end(); ++i) {
-                if (timestamp == i->start + i->execution_time) {//this process has finished
-                    processor_vec[i->processorID].busy = false;
-                    //delete this process from dependlist
-                    //scan every process's dependlist in unscheduled_vec and delete the element equals to i->processID
-                    for (auto it = unscheduled_process.begin(); it < unscheduled_process.end(); ++ it) {
-                        for (auto it2 = it->depend_list.begin(); it2 < it->depend_list.end(); ++it2) {
-                            if (*it2 == i->processID) {
-                                it->depend_list.erase(it2);
-                                --it2;
-                            }
-                        }
-                    }
-                    //delete the element in the adj_list, actually don't need it
-                    //since won't have the candidate process in adj_list
-                    for (auto it = unscheduled_process.begin(); it < unscheduled_process.end(); ++ it) {
-                        for (auto it2 = it->adj_list.begin(); it2 < it->adj_list.end(); ++it2) {
-                            if (*it2 == i->processID) {
-                                it->adj_list.erase(it2);
-                                --it2;
-                            }
+                const Process& u = process_vec[*i - 1];
+                if (u.finish <= timestamp) {//this process has finished
+                    processor_vec[u.processorID].busy = false;
+                    //one dependency less for everything that depends on it
+                    for (auto j : AdjList(u)) {
+                        if (--waiting[j - 1] == 0) {
+                            AddCandidate(process_vec[j - 1]);
                         }
                     }
                     in_processor.erase(i);
                     --i;
                 }
             }
-            FindCandidate();
+            //in priority order, each candidate goes on the processor where it can start
+            //first (ETF), counting transfers from dependencies on other processors. If
+            //that is a busy processor, or any start after a transfer, it waits
+            int idle = 0;
             for (auto &i : processor_vec) {
-                if (i.busy == false && candidate.size() != 0) {
-                    process_vec[candidate[0].processID - 1].start = timestamp;
-                    process_vec[candidate[0].processID - 1].finish = timestamp + process_vec[candidate[0].processID - 1].execution_time;
-                    process_vec[candidate[0].processID - 1].processorID = i.processorID;
-                    process_vec[candidate[0].processID - 1].depend_weight = candidate[0].depend_weight;
-                    in_processor.push_back(process_vec[candidate[0].processID - 1]);
-                    i.scheduled_process.push_back(process_vec[candidate[0].processID - 1]);
-                    candidate.erase(candidate.begin());
-                    i.busy = true;
+                idle += i.busy ? 0 : 1;
+            }
+            int next = numeric_limits<int>::max();
+            deferred.clear();
+            while (!candidate.empty() && idle > 0) {
+                Candidate c = candidate.top();
+                candidate.pop();
+                Process& u = process_vec[c.processID - 1];
+                Processor* best = nullptr;
+                int best_start = 0, best_ready = 0;
+                for (auto &i : processor_vec) {
+                    int ready = DataReady(u, i.processorID);
+                    int s = max(ready, i.busy ? process_vec[i.scheduled_process.back() - 1].finish : timestamp);
+                    if (best == nullptr || s < best_start || (s == best_start && ready < best_ready)) {
+                        best = &i;
+                        best_start = s;
+                        best_ready = ready;
+                    }
                 }
+                if (best_start > timestamp) {
+                    deferred.push_back(c);
+                    next = min(next, best_start);
+                    continue;
+                }
+                u.start = timestamp;
+                u.finish = timestamp + u.execution_time;
+                u.processorID = best->processorID;
+                u.depend_weight = c.depend_weight;
+                in_processor.push_back(u.processID);
+                best->scheduled_process.push_back(u.processID);
+                best->busy = true;
+                --idle;
+            }
+            for (auto &c : deferred) {
+                candidate.push(c);
+            }
+            for (auto id : in_processor) {
+                next = min(next, process_vec[id - 1].finish);
+            }
+            if (next == numeric_limits<int>::max()) {
+                break;
+            }
+            timestamp = next;
+        }
+    }
+};
+
+/*
+ * Where a list schedule puts process k (ID - 1) next: on the processor it
+ * can start on first, counting transfers, and of those the one that frees
+ * up first. free_at is (time, processor), earliest first; finish and
+ * processor say where the processes already placed are. Sets start and
+ * returns the index into free_at.
+ */
+int Place(Graph& g, int k, const vector<pair<int, int> >& free_at,
+          const vector<int>& finish, const vector<int>& processor, int& start) {
+    const Process& u = g.process_vec[k];
+    if (!g.has_costs) {
+        start = free_at[0].first;
+        for (auto j : g.DependList(u)) {
+            start = max(start, finish[j - 1]);
+        }
+        return 0;
+    }
+    int best = 0;
+    for (int q = 0; q < (int)free_at.size(); ++q) {
+        int s = free_at[q].first;
+        const int* c = g.cost.data() + u.depend_offset;
+        for (auto j : g.DependList(u)) {
+            s = max(s, finish[j - 1] + (processor[j - 1] != free_at[q].second ? *c : 0));
+            ++c;
+        }
+        if (q == 0 || s < start) {
+            start = s;
+            best = q;
+        }
+    }
+    return best;
+}
+
+/*
+ * Branch and bound for the optimal makespan, for small graphs.
+ *
+ * A schedule is built from a list of processes: each in turn goes on the
+ * processor that frees up first, as early as its dependencies allow. Listing
+ * an optimal schedule by start time gives a list that builds a schedule at
+ * least as good, so searching every list is exact. With transfer costs each
+ * goes where Place says instead, and that no longer holds: the result is the
+ * best list schedule, not necessarily optimal. Only lists whose
+ * processes come out in (start, ID) order are searched, which still
+ * includes an optimal one and cuts out the orders that only permute
+ * processes starting together.
+ *
+ * A branch is cut when it can't beat the best so far: some ready process
+ * still has its whole chain tail to run, and the processors still have all
+ * the remaining work to share. Solve stops when the time budget runs out,
+ * and then best is only the best found.
+ */
+class ExactSolver {
+public:
+    int processors;
+    int best;                  //best makespan so far
+    bool optimal = false;      //the search finished within the budget, and there are no transfer costs
+    long long nodes = 0;
+    vector<int> best_start = vector<int>{};      //by ID - 1, empty until something beats the upper bound
+    vector<int> best_processor = vector<int>{};
+private:
+    Graph& graph;
+    const vector<Process>& process_vec;
+    vector<int> tail;
+    vector<int> start;      //-1 while unplaced
+    vector<int> finish;
+    vector<int> processor;
+    vector<int> waiting;    //dependencies not placed yet
+    vector<pair<int, int> > free_at = vector<pair<int, int> >{};  //(time, processor), earliest first
+    long long remaining_work = 0;
+    chrono::steady_clock::time_point deadline;
+    bool out_of_time = false;
+public:
+    //upper_bound is a makespan already achieved, e.g. the list scheduler's
+    ExactSolver(Graph& g, int upper_bound)
+        : processors((int)g.processor_vec.size()), best(upper_bound), graph(g), process_vec(g.process_vec), tail(g.ChainTails()) {
+        int n = (int)process_vec.size();
+        start.assign(n, -1);
+        finish.assign(n, 0);
+        processor.assign(n, 0);
+        waiting.assign(n, 0);
+        for (auto &i : process_vec) {
+            waiting[i.processID - 1] = i.depend_count;
+            remaining_work += i.execution_time;
+        }
+        for (int k = 0; k < processors; ++k) {
+            free_at.push_back(make_pair(0, k));
+        }
+    }
+    void Solve(double seconds) {
+        deadline = chrono::steady_clock::now() + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(seconds));
+        Branch(0, 0, -1, 0);
+        optimal = !out_of_time && !graph.has_costs;
+    }
+private:
+    void Branch(int placed, int makespan, int last_start, int last_id) {
+        if ((++nodes & 1023) == 0 && chrono::steady_clock::now() > deadline) {
+            out_of_time = true;
+        }
+        if (out_of_time) {
+            return;
+        }
+        if (placed == (int)process_vec.size()) {
+            if (makespan < best) {
+                best = makespan;
+                best_start = start;
+                best_processor = processor;
+            }
+            return;
+        }
+        long long occupied = remaining_work;
+        for (auto &p : free_at) {
+            occupied += p.first;
+        }
+        int bound = max(makespan, (int)((occupied + processors - 1) / processors));
+        vector<pair<int, int> > ready; //(start, index)
+        for (int k = 0; k < (int)process_vec.size(); ++k) {
+            if (start[k] >= 0 || waiting[k] > 0) {
+                continue;
+            }
+            int s;
+            Place(graph, k, free_at, finish, processor, s);
+            bound = max(bound, max(s, last_start) + tail[k]);
+            //keep the list in (start, ID) order
+            if (s > last_start || (s == last_start && k + 1 > last_id)) {
+                ready.push_back(make_pair(s, k));
+            }
+        }
+        if (bound >= best) {
+            return;
+        }
+        //most critical first, so good schedules turn up early
+        sort(ready.begin(), ready.end(), [this](const pair<int, int>& a, const pair<int, int>& b) {
+            return tail[a.second] != tail[b.second] ? tail[a.second] > tail[b.second] : a < b;
+        });
+        vector<pair<int, int> > saved = free_at;
+        for (auto &r : ready) {
+            int k = r.second;
+            const Process& u = process_vec[k];
+            int q = Place(graph, k, free_at, finish, processor, start[k]);
+            finish[k] = start[k] + u.execution_time;
+            processor[k] = free_at[q].second;
+            free_at[q].first = finish[k];
+            sort(free_at.begin(), free_at.end());
+            for (auto i : graph.AdjList(u)) {
+                --waiting[i - 1];
+            }
+            remaining_work -= u.execution_time;
 
+            Branch(placed + 1, max(makespan, finish[k]), r.first, k + 1);
+
+            remaining_work += u.execution_time;
+            for (auto i : graph.AdjList(u)) {
+                ++waiting[i - 1];
+            }
+            free_at = saved;
+            start[k] = -1;
+            if (out_of_time || best <= bound) {
+                return;
             }
-            ++timestamp;
         }
-        --timestamp;
     }
 };
-int main(int argc, const char * argv[]) {
-    ifstream fin1(argv[1]);
-    int process_number;
-    fin1 >> process_number;
+
+/*
+ * Simulated annealing over the list a schedule is built from, the same
+ * way ExactSolver builds it. A move takes one process out of the list and
+ * puts it back somewhere after its dependencies and before its dependents.
+ * The processors' free times are saved before every list position, so a
+ * move only rebuilds the list from the first position it touched, and gives
+ * up as soon as the makespan passes what the move may cost. An undo log puts
+ * rejected moves back.
+ */
+class LocalSearch {
+public:
+    int best;                                    //best makespan so far
+    vector<int> best_order = vector<int>{};      //IDs
+    vector<int> best_start = vector<int>{};      //by ID - 1
+    vector<int> best_processor = vector<int>{};
+    long long moves = 0;
+private:
+    struct Undo {
+        int k, start, finish, processor;
+    };
+    Graph& graph;
+    const vector<Process>& process_vec;
+    int n;
+    int processors;
+    vector<int> order;       //indices, ID - 1
+    vector<int> position;    //of each index in order
+    vector<int> start, finish, processor;
+    vector<pair<int, int> > saved_free = vector<pair<int, int> >{};  //(time, processor) before each position, P per position
+    vector<int> saved_makespan;  //before each position
+    vector<pair<int, int> > free_at = vector<pair<int, int> >{};
+    vector<Undo> undo = vector<Undo>{};
+    vector<pair<int, int> > undo_free = vector<pair<int, int> >{};
+public:
+    //order is the start order of a schedule to improve on, as IDs
+    LocalSearch(Graph& g, const vector<int>& first_order)
+        : graph(g), process_vec(g.process_vec), n((int)g.process_vec.size()), processors((int)g.processor_vec.size()) {
+        position.assign(n, 0);
+        for (auto id : first_order) {
+            position[id - 1] = (int)order.size();
+            order.push_back(id - 1);
+        }
+        start.assign(n, 0);
+        finish.assign(n, 0);
+        processor.assign(n, 0);
+        saved_free.assign((size_t)(n + 1) * processors, make_pair(0, 0));
+        for (int k = 0; k < processors; ++k) {
+            saved_free[k] = make_pair(0, k);
+        }
+        saved_makespan.assign(n + 1, 0);
+        best = Rebuild(0, numeric_limits<int>::max());
+        Keep();
+    }
+    void Run(double seconds, unsigned seed) {
+        if (n < 2) {
+            return;
+        }
+        mt19937 rng(seed);
+        uniform_real_distribution<double> unit(0, 1);
+        auto begin = chrono::steady_clock::now();
+        int current = best;
+        double hot = max(1.0, 0.02 * best), cold = 0.05;  //temperatures at the start and the end
+        double temperature = hot;
+        while (true) {
+            if ((moves & 255) == 0) {
+                double elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+                if (elapsed >= seconds) {
+                    break;
+                }
+                temperature = hot * pow(cold / hot, elapsed / seconds);
+            }
+            ++moves;
+            int k = (int)(rng() % n);
+            int from = position[k];
+            //where k may go: after its last dependency, before its first dependent
+            int low = 0, high = n - 1;
+            for (auto j : graph.DependList(process_vec[k])) {
+                low = max(low, position[j - 1] + 1);
+            }
+            for (auto j : graph.AdjList(process_vec[k])) {
+                high = min(high, position[j - 1] - 1);
+            }
+            if (high <= low) {
+                continue;
+            }
+            int to = low + (int)(rng() % (high - low));
+            if (to >= from) {
+                ++to;
+            }
+            Move(from, to);
+            //accept anything up to a random allowance, so the search can climb out of local minima
+            int allowance = (int)(-temperature * log(1 - unit(rng)));
+            int limit = current > numeric_limits<int>::max() - allowance ? numeric_limits<int>::max() : current + allowance;
+            int makespan = Rebuild(min(from, to), limit);
+            if (makespan > limit) {
+                Rollback();
+                Move(to, from);
+                continue;
+            }
+            current = makespan;
+            if (current < best) {
+                best = current;
+                Keep();
+            }
+        }
+    }
+private:
+    //take the process at from out of the list and put it back at to
+    void Move(int from, int to) {
+        int k = order[from];
+        if (from < to) {
+            for (int p = from; p < to; ++p) {
+                order[p] = order[p + 1];
+                position[order[p]] = p;
+            }
+        } else {
+            for (int p = from; p > to; --p) {
+                order[p] = order[p - 1];
+                position[order[p]] = p;
+            }
+        }
+        order[to] = k;
+        position[k] = to;
+    }
+    //rebuild from position first on; stops and returns past limit once the makespan is past it
+    int Rebuild(int first, int limit) {
+        undo.clear();
+        undo_free.clear();
+        free_at.assign(saved_free.begin() + (size_t)first * processors, saved_free.begin() + (size_t)(first + 1) * processors);
+        int makespan = saved_makespan[first];
+        for (int p = first; p < n; ++p) {
+            int k = order[p];
+            undo.push_back(Undo{k, start[k], finish[k], processor[k]});
+            int q = Place(graph, k, free_at, finish, processor, start[k]);
+            finish[k] = start[k] + process_vec[k].execution_time;
+            processor[k] = free_at[q].second;
+            free_at[q].first = finish[k];
+            for (; q + 1 < processors && free_at[q + 1] < free_at[q]; ++q) {
+                swap(free_at[q], free_at[q + 1]);
+            }
+            makespan = max(makespan, finish[k]);
+            if (makespan > limit) {
+                return makespan;
+            }
+            auto saved = saved_free.begin() + (size_t)(p + 1) * processors;
+            undo_free.insert(undo_free.end(), saved, saved + processors);
+            copy(free_at.begin(), free_at.end(), saved);
+            undo_free.push_back(make_pair(saved_makespan[p + 1], 0));
+            saved_makespan[p + 1] = makespan;
+        }
+        return makespan;
+    }
+    //undo the last Rebuild
+    void Rollback(void) {
+        for (auto &u : undo) {
+            start[u.k] = u.start;
+            finish[u.k] = u.finish;
+            processor[u.k] = u.processor;
+        }
+        //one block of saved free times and the saved makespan per position that was fully rebuilt
+        int first = position[undo[0].k];
+        for (size_t b = 0; b * (processors + 1) < undo_free.size(); ++b) {
+            auto block = undo_free.begin() + b * (processors + 1);
+            copy(block, block + processors, saved_free.begin() + (size_t)(first + b + 1) * processors);
+            saved_makespan[first + b + 1] = block[processors].first;
+        }
+    }
+    void Keep(void) {
+        best_order.clear();
+        for (auto k : order) {
+            best_order.push_back(k + 1);
+        }
+        best_start = start;
+        best_processor = processor;
+    }
+};
+
+//runs one LocalSearch per thread from the same start, different seeds, and keeps the best
+LocalSearch Improve(Graph& g, double seconds, unsigned threads) {
+    vector<int> first_order = g.ScheduleOrder();
+    vector<LocalSearch> searches(max(1u, threads), LocalSearch(g, first_order));
+    vector<thread> workers;
+    for (unsigned t = 1; t < searches.size(); ++t) {
+        workers.emplace_back([&searches, seconds, t] { searches[t].Run(seconds, t + 1); });
+    }
+    searches[0].Run(seconds, 1);
+    for (auto &w : workers) {
+        w.join();
+    }
+    size_t best = 0;
+    long long moves = 0;
+    for (size_t t = 0; t < searches.size(); ++t) {
+        moves += searches[t].moves;
+        if (searches[t].best < searches[best].best) {
+            best = t;
+        }
+    }
+    searches[best].moves = moves;
+    return searches[best];
+}
+
+void WriteMetricsJSON(ostream& out, const vector<pair<string, ScheduleMetrics> >& reports) {
+    out << "{\"schedules\":[";
+    for (size_t r = 0; r < reports.size(); ++r) {
+        const ScheduleMetrics& m = reports[r].second;
+        out << (r ? "," : "") << "\n{\"name\":\"" << reports[r].first << "\""
+            << ",\"makespan\":" << m.makespan
+            << ",\"critical_path\":" << m.critical_path
+            << ",\"makespan_ratio\":" << m.makespan_ratio
+            << ",\"processors\":[";
+        for (size_t k = 0; k < m.processors.size(); ++k) {
+            const ProcessorMetrics& pm = m.processors[k];
+            out << (k ? "," : "") << "\n {\"id\":" << pm.processorID
+                << ",\"busy_time\":" << pm.busy_time
+                << ",\"utilization\":" << pm.utilization
+                << ",\"idle_gaps\":[";
+            for (size_t g = 0; g < pm.idle_gaps.size(); ++g) {
+                out << (g ? "," : "") << "[" << pm.idle_gaps[g].first << "," << pm.idle_gaps[g].second << "]";
+            }
+            out << "]}";
+        }
+        out << "],\"tasks\":[";
+        for (size_t k = 0; k < m.tasks.size(); ++k) {
+            const TaskMetrics& t = m.tasks[k];
+            out << (k ? "," : "") << "\n {\"id\":" << t.processID
+                << ",\"processor\":" << t.processorID
+                << ",\"start\":" << t.start
+                << ",\"finish\":" << t.finish
+                << ",\"ready\":" << t.ready
+                << ",\"wait\":" << t.wait << "}";
+        }
+        out << "]}";
+    }
+    out << "]}" << endl;
+}
+
+//long format, one fact per row: schedule,record,id,processor,from,to,value
+void WriteMetricsCSV(ostream& out, const vector<pair<string, ScheduleMetrics> >& reports) {
+    out << "schedule,record,id,processor,from,to,value\n";
+    for (auto &r : reports) {
+        const string& s = r.first;
+        const ScheduleMetrics& m = r.second;
+        out << s << ",makespan,,,,," << m.makespan << "\n";
+        out << s << ",critical_path,,,,," << m.critical_path << "\n";
+        out << s << ",makespan_ratio,,,,," << m.makespan_ratio << "\n";
+        for (auto &pm : m.processors) {
+            out << s << ",busy_time,," << pm.processorID << ",,," << pm.busy_time << "\n";
+            out << s << ",utilization,," << pm.processorID << ",,," << pm.utilization << "\n";
+            for (auto &g : pm.idle_gaps) {
+                out << s << ",idle," << "," << pm.processorID << "," << g.first << "," << g.second << "," << g.second - g.first << "\n";
+            }
+        }
+        //a task's ready time is from, its start is from + wait
+        for (auto &t : m.tasks) {
+            out << s << ",task," << t.processID << "," << t.processorID << "," << t.ready << "," << t.finish << "," << t.wait << "\n";
+        }
+    }
+    out.flush();
+}
+
+/*
+ * Online scheduling for --stream. Records come one at a time, and each
+ * process starts as soon as its dependencies are done and a processor is
+ * free, first come first served, on the free processor its dependencies'
+ * output reaches first. A line "@T" moves the clock to T, finishing
+ * whatever finishes by then, and the records after it arrive at T. Drain
+ * runs the clock until everything has finished.
+ *
+ * IDs must arrive as 1, 2, 3, ... so every lower ID has arrived already; a
+ * dependency on a higher ID waits for that ID to arrive. Arrive rejects a
+ * record out of that order, or one depending on itself or on an ID below 1.
+ *
+ * An arrival or a finish costs O(log n) plus the edges it touches. Only
+ * processes that haven't finished are kept, and finished ones until the
+ * clock is past their finish plus the largest transfer cost seen so far.
+ * A later edge from a forgotten process with a larger cost than that may
+ * still matter, and its finish is gone: it is taken to finish as late as
+ * any forgotten process did, which is safe but may start the dependent
+ * later than needed. assumed_transfers counts those edges.
+ */
+class StreamScheduler {
+public:
+    int now = 0;
+    int makespan = 0;
+    size_t most_kept = 0;  //the most processes kept at once
+    int assumed_transfers = 0;
+private:
+    struct Task {
+        bool arrived = false;   //false while only known as a dependency
+        bool finished = false;
+        int execution_time = 0;
+        int waiting = 0;        //dependencies not finished yet
+        int finish = 0;
+        int processorID = -1;
+        vector<int> ready_on = vector<int>{};  //when the finished dependencies' output is on each processor
+        vector<pair<int, int> > dependents = vector<pair<int, int> >{};  //(ID, transfer cost)
+    };
+    ostream& out;
+    int processors;
+    int free_processors;
+    vector<bool> busy;
+    unordered_map<int, Task> kept = unordered_map<int, Task>{};
+    int last_id = 0;
+    int max_cost = 0;
+    int retired_finish = 0;  //the latest finish of a forgotten process
+    priority_queue<int, vector<int>, greater<int> > ready = priority_queue<int, vector<int>, greater<int> >{};
+    //(finish, processor, ID)
+    priority_queue<tuple<int, int, int>, vector<tuple<int, int, int> >, greater<tuple<int, int, int> > > running
+        = priority_queue<tuple<int, int, int>, vector<tuple<int, int, int> >, greater<tuple<int, int, int> > >{};
+    deque<pair<int, int> > finished = deque<pair<int, int> >{};  //(finish, ID), in finish order
+public:
+    StreamScheduler(ostream& out, int processors)
+        : out(out), processors(processors), free_processors(processors), busy(processors, false) {}
+    //depend holds p's dependencies and costs their transfer costs; false if p isn't
+    //the next ID or depends on itself or on an ID below 1
+    bool Arrive(const Process& p, const vector<int>& depend, const vector<int>& costs) {
+        if (p.processID != last_id + 1) {
+            return false;
+        }
+        for (auto j : depend) {
+            if (j < 1 || j == p.processID) {
+                return false;
+            }
+        }
+        last_id = p.processID;
+        Task& t = kept[p.processID];  //may be there already, as a dependency
+        t.arrived = true;
+        t.execution_time = p.execution_time;
+        t.ready_on.assign(processors, now);
+        for (size_t k = 0; k < depend.size(); ++k) {
+            int j = depend[k];
+            max_cost = max(max_cost, costs[k]);
+            auto d = kept.find(j);
+            if (d == kept.end()) {
+                if (j < p.processID) {
+                    //forgotten, so finished by retired_finish
+                    if (retired_finish + costs[k] > now) {
+                        ++assumed_transfers;
+                        for (auto &r : t.ready_on) {
+                            r = max(r, retired_finish + costs[k]);
+                        }
+                    }
+                    continue;
+                }
+                d = kept.emplace(j, Task()).first;
+            }
+            if (d->second.finished) {
+                Deliver(t, d->second, costs[k]);
+            } else {
+                d->second.dependents.push_back(make_pair(p.processID, costs[k]));
+                ++t.waiting;
+            }
+        }
+        if (t.waiting == 0) {
+            ready.push(p.processID);
+        }
+        most_kept = max(most_kept, kept.size());
+        Dispatch();
+        return true;
+    }
+    //finish everything that finishes by time, in order, then set the clock to it
+    void Advance(int time) {
+        while (!running.empty() && get<0>(running.top()) <= time) {
+            now = get<0>(running.top());
+            while (!running.empty() && get<0>(running.top()) == now) {
+                Finish(get<2>(running.top()), get<1>(running.top()));
+                running.pop();
+            }
+            Retire();
+            Dispatch();
+        }
+        now = max(now, time);
+        Retire();
+    }
+    void Drain(void) {
+        while (!running.empty()) {
+            Advance(get<0>(running.top()));
+        }
+    }
+    //processes that arrived but never became ready
+    int Stuck(void) {
+        int stuck = 0;
+        for (auto &t : kept) {
+            stuck += t.second.arrived && !t.second.finished ? 1 : 0;
+        }
+        return stuck;
+    }
+private:
+    void Deliver(Task& to, const Task& from, int cost) {
+        for (int p = 0; p < processors; ++p) {
+            to.ready_on[p] = max(to.ready_on[p], from.finish + (p != from.processorID ? cost : 0));
+        }
+    }
+    void Dispatch(void) {
+        while (free_processors > 0 && !ready.empty()) {
+            int id = ready.top();
+            ready.pop();
+            Task& t = kept[id];
+            int best = -1;
+            for (int p = 0; p < processors; ++p) {
+                if (!busy[p] && (best < 0 || t.ready_on[p] < t.ready_on[best])) {
+                    best = p;
+                }
+            }
+            int start = max(now, t.ready_on[best]); //the processor waits for the transfer
+            t.finish = start + t.execution_time;
+            t.processorID = best;
+            busy[best] = true;
+            --free_processors;
+            running.push(make_tuple(t.finish, best, id));
+            out << "ID:" << id << " Start:" << start << " Finish:" << t.finish << " Processor ID:" << best << "\n";
+        }
+    }
+    void Finish(int id, int processor) {
+        busy[processor] = false;
+        ++free_processors;
+        Task& d = kept[id];
+        d.finished = true;
+        makespan = max(makespan, d.finish);
+        for (auto &w : d.dependents) {
+            Task& t = kept[w.first];
+            Deliver(t, d, w.second);
+            if (--t.waiting == 0) {
+                ready.push(w.first);
+            }
+        }
+        vector<pair<int, int> >().swap(d.dependents);
+        finished.push_back(make_pair(d.finish, id));
+    }
+    //forget finished processes no transfer can wait for any more
+    void Retire(void) {
+        while (!finished.empty() && finished.front().first + max_cost <= now) {
+            retired_finish = max(retired_finish, finished.front().first);
+            kept.erase(finished.front().second);
+            finished.pop_front();
+        }
+    }
+};
+
+//one line of the --batch report
+struct BatchResult {
+    string file;
+    int processes = 0;
+    int t3 = 0;
+    int t3b = 0;
+    int lower_bound = 0;
+    string status;
+};
+
+/*
+ * --batch: schedules every file on a pool of threads, then prints one CSV
+ * record per file, in order. Each thread keeps its text buffer and its two
+ * Graphs from one file to the next.
+ */
+int Batch(const string& path, unsigned threads) {
+    vector<string> files = BatchFiles(path);
+    vector<BatchResult> results(files.size());
+    atomic<size_t> next(0);
+    auto work = [&files, &results, &next](void) {
+        string text;
+        Graph g, g2;
+        for (size_t k = next++; k < files.size(); k = next++) {
+            BatchResult& r = results[k];
+            r.file = files[k];
+            g.Reset();
+            LoadStatus status = LoadGraph(files[k], text, g, &g.cost);
+            if (status != LoadStatus::ok) {
+                r.status = status == LoadStatus::unreadable ? "unreadable" : "malformed";
+                continue;
+            }
+            r.processes = (int)g.process_vec.size();
+            g.ConstructGraph();
+            g2 = g;
+            g2.baseline = true;
+            g.DFS();
+            if (g.has_cycle) {
+                r.status = "cycle";
+                continue;
+            }
+            g.schedule();
+            g2.schedule();
+            r.t3 = g.timestamp;
+            r.t3b = g2.timestamp;
+            r.lower_bound = g.ComputeLowerBound().value;
+            r.status = "ok";
+        }
+    };
+    vector<thread> pool;
+    for (unsigned t = 1; t < max(1u, threads); ++t) {
+        pool.emplace_back(work);
+    }
+    work();
+    for (auto &t : pool) {
+        t.join();
+    }
+    cout << "file,processes,T3,T3B,lower_bound,status\n";
+    for (auto &r : results) {
+        cout << r.file << "," << r.processes << "," << r.t3 << "," << r.t3b << ","
+             << r.lower_bound << "," << r.status << "\n";
+    }
+    cout.flush();
+    return 0;
+}
+
+int Stream(const string& file) {
+    ifstream fin;
+    if (file != "-") {
+        fin.open(file);
+    }
+    istream& in = file == "-" ? cin : fin;
+    StreamScheduler scheduler(cout, 3);
     Process p;
-    Graph g;
-    string s;
-    int number;
-    vector<Process> process_vec;
-    char garbage;
-    while (fin1 >> p.processID >> p.execution_time) {
-        vector<int> depend_list;
-        fin1 >> garbage;
-        while (fin1 >> number) {
-            char delimiter;
-            depend_list.push_back(number);
-            fin1 >> delimiter;
-            if (delimiter == '}') {
-                fin1.unget();
-                break;
+    vector<int> depend, costs;
+    string line;
+    bool first = true;
+    //a line at a time, so a record is scheduled as soon as its line is complete
+    while (getline(in, line)) {
+        const char* c = line.data();
+        const char* end = c + line.size();
+        SkipBlanks(c, end);
+        if (c == end) {
+            continue;
+        }
+        int time;
+        if (first) {
+            //the count line of a whole input file, which a stream doesn't need
+            first = false;
+            const char* count = c;
+            if (ReadInt(count, end, time) && (SkipBlanks(count, end), count == end)) {
+                continue;
             }
         }
-        if (fin1.fail()) {
-            fin1.clear();
+        if (*c == '@') {
+            if (!ReadChar(c, end, '@') || !ReadInt(c, end, time) || (SkipBlanks(c, end), c != end)) {
+                cerr << "malformed line " << line << endl;
+                return 1;
+            }
+            scheduler.Advance(time);
+        } else {
+            //the same rules as LoadGraph's, bar the IDs, which Arrive checks
+            depend.clear();
+            costs.clear();
+            if (!ReadRecord(c, end, p.processID, p.execution_time, depend, &costs)
+                || (SkipBlanks(c, end), c != end)) {
+                cerr << "malformed record " << line << endl;
+                return 1;
+            }
+            if (!scheduler.Arrive(p, depend, costs)) {
+                cerr << "ID " << p.processID << " is out of order or depends on itself or on an ID below 1, ignored" << endl;
+            }
+        }
+        cout.flush();
+    }
+    scheduler.Drain();
+    cout << "The makespan is:" << scheduler.makespan << endl;
+    cout << "At most " << scheduler.most_kept << " processes were kept at once" << endl;
+    int stuck = scheduler.Stuck();
+    if (stuck != 0) {
+        cout << stuck << " processes never became ready" << endl;
+    }
+    if (scheduler.assumed_transfers != 0) {
+        cout << scheduler.assumed_transfers << " transfers were from processes already forgotten, and assumed to arrive as late as they could" << endl;
+    }
+    return 0;
+}
+
+//percent above reference
+double Gap(int makespan, int reference) {
+    return reference > 0 ? 100.0 * (makespan - reference) / reference : 0;
+}
+
+/*
+ * options after the input file:
+ *   --json FILE / --csv FILE  write the metrics of both schedules, "-" is stdout
+ *   --bound                   report the lower bound and how far T3 and T3B are above it
+ *   --exact SECONDS           also run the branch and bound solver for at most SECONDS
+ *   --improve SECONDS         improve on T3 by local search for SECONDS, and print that schedule too
+ *   --threads N               threads for --improve, one per hardware thread by default
+ *   --stream                  schedule online as records arrive (see StreamScheduler),
+ *                             the input file may be "-" for stdin. IDs must come as
+ *                             1, 2, 3, ..., other records are rejected; a count line
+ *                             first is skipped. A malformed record, as a whole file
+ *                             would have it, stops the stream. A transfer from a
+ *                             process forgotten already is assumed to arrive as late
+ *                             as it could
+ *   --timing                  time reading, the cycle check, the critical path and both
+ *                             schedules, on stderr (inputs from DAGGenerator for example)
+ * or instead of all that, "--batch DIRECTORY|MANIFEST [--threads N]" to
+ * schedule many files and print a line for each
+ */
+int main(int argc, const char * argv[]) {
+    if (argc > 2 && string(argv[1]) == "--batch") {
+        unsigned threads = thread::hardware_concurrency();
+        if (argc > 4 && string(argv[3]) == "--threads") {
+            threads = (unsigned)atoi(argv[4]);
+        }
+        return Batch(argv[2], threads);
+    }
+    string json_file, csv_file;
+    bool bound = false;
+    double exact_seconds = -1;
+    double improve_seconds = -1;
+    unsigned threads = thread::hardware_concurrency();
+    bool timing = false;
+    for (int a = 2; a < argc; ++a) {
+        string flag = argv[a];
+        if (flag == "--bound") {
+            bound = true;
+        } else if (flag == "--timing") {
+            timing = true;
+        } else if (flag == "--json" && a + 1 < argc) {
+            json_file = argv[++a];
+        } else if (flag == "--csv" && a + 1 < argc) {
+            csv_file = argv[++a];
+        } else if (flag == "--exact" && a + 1 < argc) {
+            exact_seconds = atof(argv[++a]);
+        } else if (flag == "--improve" && a + 1 < argc) {
+            improve_seconds = atof(argv[++a]);
+        } else if (flag == "--threads" && a + 1 < argc) {
+            threads = (unsigned)atoi(argv[++a]);
+        } else if (flag == "--stream") {
+            return Stream(argv[1]);
+        } else {
+            cerr << "unknown option " << flag << endl;
+            return 1;
+        }
+    }
+    //the time since the last lap, on stderr so the output stays the same
+    auto lap_start = chrono::steady_clock::now();
+    auto lap = [&lap_start, timing](const string& phase) {
+        auto now = chrono::steady_clock::now();
+        if (timing) {
+            cerr << "The " << phase << " time is:" << chrono::duration<double, milli>(now - lap_start).count() << " ms" << endl;
         }
-        fin1 >> garbage;
-        p.depend_list = depend_list;
-        process_vec.push_back(p);
-        g.process_vec = process_vec;
+        lap_start = now;
+    };
+    Graph g;
+    string text;
+    //a dependency may carry a transfer cost, "{2:5,3}": 5 to move 2's output, 3's is free
+    LoadStatus status = LoadGraph(argv[1], text, g, &g.cost);
+    if (status != LoadStatus::ok) {
+        cerr << (status == LoadStatus::unreadable ? "can't read " : "malformed input in ") << argv[1] << endl;
+        return 1;
     }
     g.ConstructGraph();
     Graph g2 = g;
     g2.baseline = true;
+    lap("parse");
     g.DFS();
+    lap("cycle check");
     if (g.has_cycle) {
         cout << "There is no feasible solution.\n";
     } else {
+        if (timing) {
+            LowerBound b = g.ComputeLowerBound();
+            lap("critical path");
+            cerr << "The critical path is:" << b.critical_path << endl;
+            lap_start = chrono::steady_clock::now();
+        }
         g.schedule();
+        lap("schedule");
         g2.schedule();
+        lap("baseline schedule");
         cout << "The T3 of my algorithm is:" << g.timestamp << endl;
         cout << "The T3B is:" << g2.timestamp << endl;
         cout << "The start time of each process in my algorithm is:" << endl;
         g.PrintProcess();
+
+        if (bound || exact_seconds >= 0) {
+            LowerBound b = g.ComputeLowerBound();
+            cout << "The lower bound is:" << b.value << " (critical path " << b.critical_path
+                 << ", work per processor " << b.work << ")" << endl;
+            cout << "The gap of T3 is:" << Gap(g.timestamp, b.value) << "%" << endl;
+            cout << "The gap of T3B is:" << Gap(g2.timestamp, b.value) << "%" << endl;
+            if (exact_seconds >= 0) {
+                ExactSolver solver(g, min(g.timestamp, g2.timestamp));
+                solver.Solve(exact_seconds);
+                cout << (solver.optimal ? "The optimal makespan is:" : "The best makespan found is:")
+                     << solver.best << " (" << solver.nodes << " nodes)" << endl;
+                cout << "The gap of T3 to it is:" << Gap(g.timestamp, solver.best) << "%" << endl;
+                cout << "The gap of T3B to it is:" << Gap(g2.timestamp, solver.best) << "%" << endl;
+            }
+        }
+
+        Graph g3;
+        if (improve_seconds >= 0) {
+            LocalSearch improved = Improve(g, improve_seconds, threads);
+            g3 = g;
+            //rebuilt as a list schedule, T3's order can come out longer than T3 once
+            //transfers count; keep T3's own schedule unless the search beat it
+            if (improved.best < g.timestamp) {
+                g3.ApplySchedule(improved.best_order, improved.best_start, improved.best_processor);
+            }
+            cout << "The improved T3 is:" << g3.timestamp << " (" << (g.timestamp > 0 ? 100.0 * (g.timestamp - g3.timestamp) / g.timestamp : 0)
+                 << "% below T3, " << improved.moves << " moves)" << endl;
+            cout << "The start time of each process after improvement is:" << endl;
+            g3.PrintProcess();
+        }
+
+        vector<pair<string, ScheduleMetrics> > reports;
+        if (!json_file.empty() || !csv_file.empty()) {
+            reports.push_back(make_pair(string("weighted"), g.ComputeMetrics()));
+            reports.push_back(make_pair(string("baseline"), g2.ComputeMetrics()));
+            if (improve_seconds >= 0) {
+                reports.push_back(make_pair(string("improved"), g3.ComputeMetrics()));
+            }
+        }
+        if (json_file == "-") {
+            WriteMetricsJSON(cout, reports);
+        } else if (!json_file.empty()) {
+            ofstream fout(json_file);
+            WriteMetricsJSON(fout, reports);
+        }
+        if (csv_file == "-") {
+            WriteMetricsCSV(cout, reports);
+        } else if (!csv_file.empty()) {
+            ofstream fout(csv_file);
+            WriteMetricsCSV(fout, reports);
+        }
     }
     return 0;
 }
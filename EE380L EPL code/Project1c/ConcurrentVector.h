@@ -0,0 +1,197 @@
+#ifndef _CONCURRENT_VECTOR_H_
+#define _CONCURRENT_VECTOR_H_
+
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace epl{
+    /*
+     * concurrent_vector is an append only vector that any number of threads
+     * can push into at once without a lock, while other threads read it.
+     *
+     * A push claims its index with one fetch_add on the size and then builds
+     * the element in place. Storage is a fixed directory of segments that
+     * double in size (FirstSegment, 2 * FirstSegment, ...), each installed
+     * once with a compare and swap and never moved, so an element's address
+     * never changes and readers are never invalidated. Every slot has a
+     * state that the pushing thread stores with release once the element is
+     * built; readers load it with acquire before they look at the element.
+     *
+     * size() counts claimed slots, so an element below size() may still be
+     * under construction: ready(k) says whether it is done, and operator[]
+     * waits for it. Nothing can be removed while other threads are using the
+     * vector; the destructor is the only cleanup.
+     */
+    template <typename T, uint64_t FirstSegment = 64>
+    class concurrent_vector {
+        static_assert(FirstSegment > 0 && (FirstSegment & (FirstSegment - 1)) == 0,
+                      "FirstSegment must be a power of two");
+    private:
+        enum : uint8_t { EMPTY, PUBLISHED, FAILED };
+
+        struct segment {
+            T* elements;
+            std::atomic<uint8_t>* state;
+        };
+
+        static constexpr unsigned max_segments = 64;
+
+        std::atomic<uint64_t> claimed{0};
+        std::atomic<segment*> directory[max_segments];
+
+    public:
+        using value_type = T;
+
+        concurrent_vector(void) {
+            for (unsigned s = 0; s < max_segments; s++) {
+                directory[s].store(nullptr, std::memory_order_relaxed);
+            }
+        }
+
+        concurrent_vector(const concurrent_vector&) = delete;
+        concurrent_vector& operator=(const concurrent_vector&) = delete;
+
+        ~concurrent_vector(void) {
+            for (unsigned s = 0; s < max_segments; s++) {
+                segment* seg = directory[s].load(std::memory_order_acquire);
+                if (seg == nullptr) {
+                    continue;
+                }
+                for (uint64_t k = 0; k < (FirstSegment << s); k++) {
+                    if (seg->state[k].load(std::memory_order_relaxed) == PUBLISHED) {
+                        seg->elements[k].~T();
+                    }
+                }
+                free_segment(seg);
+            }
+        }
+
+        //number of slots handed out, some may still be under construction
+        uint64_t size(void) const {
+            return claimed.load(std::memory_order_acquire);
+        }
+
+        //true once element k is built and visible to this thread
+        bool ready(uint64_t k) const {
+            if (k >= size()) {
+                return false;
+            }
+            unsigned s;
+            uint64_t offset;
+            locate(k, s, offset);
+            segment* seg = directory[s].load(std::memory_order_acquire);
+            return seg != nullptr && seg->state[offset].load(std::memory_order_acquire) == PUBLISHED;
+        }
+
+        //waits for element k if another thread is still building it
+        T& operator[](uint64_t k) {
+            return const_cast<T&>(static_cast<const concurrent_vector&>(*this)[k]);
+        }
+
+        const T& operator[](uint64_t k) const {
+            if (k >= size()) {
+                throw std::out_of_range("subscript out of range");
+            }
+            unsigned s;
+            uint64_t offset;
+            locate(k, s, offset);
+            segment* seg;
+            while ((seg = directory[s].load(std::memory_order_acquire)) == nullptr) {
+                std::this_thread::yield();
+            }
+            uint8_t state;
+            while ((state = seg->state[offset].load(std::memory_order_acquire)) == EMPTY) {
+                std::this_thread::yield();
+            }
+            if (state == FAILED) {
+                throw std::out_of_range("element failed to construct");
+            }
+            return seg->elements[offset];
+        }
+
+        //push_back and emplace_back return the index the element went to
+        uint64_t push_back(const T& data) {
+            return emplace_back(data);
+        }
+
+        uint64_t push_back(T&& data) {
+            return emplace_back(std::move(data));
+        }
+
+        template <typename... Args>
+        uint64_t emplace_back(Args&&... args) {
+            uint64_t k = claimed.fetch_add(1, std::memory_order_relaxed);
+            unsigned s;
+            uint64_t offset;
+            locate(k, s, offset);
+            segment* seg = install(s);
+            if (offset == 0 && s + 1 < max_segments) {
+                //whoever opens a segment sets up the next one, so the other
+                //pushers rarely find a missing segment and race to allocate it
+                install(s + 1);
+            }
+            try {
+                new(seg->elements + offset) T(std::forward<Args>(args)...);
+            } catch (...) {
+                seg->state[offset].store(FAILED, std::memory_order_release);
+                throw;
+            }
+            seg->state[offset].store(PUBLISHED, std::memory_order_release);
+            return k;
+        }
+
+    private:
+        static unsigned highest_bit(uint64_t x) {
+#if defined(_MSC_VER)
+            unsigned long i;
+            _BitScanReverse64(&i, x);
+            return (unsigned)i;
+#else
+            return 63 - __builtin_clzll(x);
+#endif
+        }
+
+        //segment s holds the elements from FirstSegment * (2^s - 1) on
+        static void locate(uint64_t k, unsigned& s, uint64_t& offset) {
+            s = highest_bit(k / FirstSegment + 1);
+            offset = k - FirstSegment * ((uint64_t(1) << s) - 1);
+        }
+
+        segment* install(unsigned s) {
+            segment* seg = directory[s].load(std::memory_order_acquire);
+            if (seg != nullptr) {
+                return seg;
+            }
+            segment* fresh = new_segment(FirstSegment << s);
+            if (directory[s].compare_exchange_strong(seg, fresh, std::memory_order_acq_rel,
+                                                     std::memory_order_acquire)) {
+                return fresh;
+            }
+            free_segment(fresh); //another thread won, seg is now its segment
+            return seg;
+        }
+
+        static segment* new_segment(uint64_t n) {
+            segment* seg = new segment;
+            seg->elements = (T*)operator new(sizeof(T) * n);
+            seg->state = new std::atomic<uint8_t>[n](); //all EMPTY
+            return seg;
+        }
+
+        static void free_segment(segment* seg) {
+            operator delete(seg->elements);
+            delete[] seg->state;
+            delete seg;
+        }
+    };
+
+} //namespace epl
+
+#endif /* _CONCURRENT_VECTOR_H_ */
@@ -0,0 +1,107 @@
+/*
+ * ConcurrentVector_unittests.cpp
+ *
+ * Tests for epl::concurrent_vector, the lock-free append vector in
+ * ConcurrentVector.h. main() is in Vector_PhaseA_unittests.cpp.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "ConcurrentVector.h"
+
+using epl::concurrent_vector;
+
+TEST(ConcurrentVector, single_thread) {
+    concurrent_vector<std::string, 4> x;
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(i, x.push_back(std::to_string(i)));
+    }
+    EXPECT_EQ(100, x.size());
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_TRUE(x.ready(i));
+        EXPECT_EQ(std::to_string(i), x[i]);
+    }
+    EXPECT_FALSE(x.ready(100));
+    EXPECT_THROW(x[100], std::out_of_range);
+}
+
+TEST(ConcurrentVector, concurrent_push_back) {
+    const int threads = 8;
+    const int per_thread = 20000;
+    concurrent_vector<int, 8> x;
+    std::atomic<bool> done{false};
+
+    // a reader checks every published element while the writers run
+    std::thread reader([&] {
+        while (!done.load()) {
+            uint64_t n = x.size();
+            for (uint64_t k = 0; k < n; k += 97) {
+                if (x.ready(k)) {
+                    EXPECT_LE(0, x[k]);
+                }
+            }
+        }
+    });
+
+    std::vector<std::thread> writers;
+    for (int t = 0; t < threads; ++t) {
+        writers.emplace_back([&x, t] {
+            for (int i = 0; i < per_thread; ++i) {
+                x.push_back(t * per_thread + i);
+            }
+        });
+    }
+    for (auto& w : writers) {
+        w.join();
+    }
+    done.store(true);
+    reader.join();
+
+    // every value went in exactly once
+    ASSERT_EQ(threads * per_thread, x.size());
+    std::vector<int> seen(threads * per_thread, 0);
+    for (uint64_t k = 0; k < x.size(); ++k) {
+        seen[x[k]] += 1;
+    }
+    for (int count : seen) {
+        EXPECT_EQ(1, count);
+    }
+}
+
+TEST(ConcurrentVector, references_are_stable) {
+    concurrent_vector<std::unique_ptr<int>, 2> x;
+    x.emplace_back(new int(42));
+    std::unique_ptr<int>* first = &x[0];
+    for (int i = 0; i < 1000; ++i) {
+        x.push_back(std::unique_ptr<int>(new int(i)));
+    }
+    EXPECT_EQ(first, &x[0]);
+    EXPECT_EQ(42, *x[0]);
+    EXPECT_EQ(999, *x[1000]);
+}
+
+namespace {
+    struct Fragile {
+        Fragile(bool fail) {
+            if (fail) {
+                throw std::runtime_error("constructor failed");
+            }
+        }
+    };
+}
+
+TEST(ConcurrentVector, failed_construction) {
+    concurrent_vector<Fragile> x;
+    x.emplace_back(false);
+    EXPECT_THROW(x.emplace_back(true), std::runtime_error);
+    x.emplace_back(false);
+    EXPECT_EQ(3, x.size());
+    EXPECT_FALSE(x.ready(1));
+    EXPECT_THROW(x[1], std::out_of_range);
+    EXPECT_TRUE(x.ready(2));
+}
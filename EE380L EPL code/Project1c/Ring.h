@@ -0,0 +1,272 @@
+#ifndef _RING_H_
+#define _RING_H_
+
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+#include "SequenceIterator.h"
+
+namespace epl{
+    /*
+     * ring is a double ended queue in one circular buffer. The elements live
+     * at head, head + 1, ... wrapping around at the end of the storage, so
+     * push/pop at either end only moves head and length. Storage is only
+     * replaced when the ring is full; a queue that stays below its high water
+     * mark never allocates again.
+     *
+     * Iterators are sequence_iterators, so they survive pushes, pops at the
+     * other end and growth.
+     */
+    template <typename T>
+    class ring {
+    private:
+        T* buffer;
+        uint64_t capacity; // always a power of two, so wrapping is a mask
+        uint64_t head;
+        uint64_t length;
+
+        int64_t front_sequence{0}; // sequence number of the element at head
+        uint64_t assignmentversion{0};
+
+        static constexpr uint64_t mincapacity = 8;
+
+        template <typename Container, typename Ref>
+        friend class sequence_iterator;
+
+    public:
+        using value_type = T;
+
+        using iterator = sequence_iterator<ring<T>, T&>;
+        using const_iterator = sequence_iterator<const ring<T>, const T&>;
+
+        ring(void) {
+            allocate_empty(mincapacity);
+        }
+
+        ring(std::initializer_list<T> list) {
+            allocate_empty(round_up(list.size()));
+            for (const T& v : list) {
+                new(buffer + length) T{v};
+                ++length;
+            }
+        }
+
+        ring(const ring<T>& that) {
+            copy(that);
+        }
+
+        ring(ring<T>&& that) noexcept {
+            move(std::move(that));
+        }
+
+        ring<T>& operator=(const ring<T>& that) {
+            if (this != &that) {
+                destroy();
+                copy(that);
+            }
+            assignmentversion += 1;
+            return *this;
+        }
+
+        ring<T>& operator=(ring<T>&& that) {
+            if (this != &that) {
+                destroy();
+                move(std::move(that));
+            }
+            assignmentversion += 1;
+            that.assignmentversion += 1;
+            return *this;
+        }
+
+        ~ring(void) {
+            destroy();
+        }
+
+        uint64_t size(void) const {
+            return length;
+        }
+
+        //number of elements the ring holds before it has to allocate
+        uint64_t reserved(void) const {
+            return capacity;
+        }
+
+        T& operator[](uint64_t k) {
+            if (k >= length) {
+                throw std::out_of_range("subscript out of range");
+            }
+            return at(k);
+        }
+
+        const T& operator[](uint64_t k) const {
+            if (k >= length) {
+                throw std::out_of_range("subscript out of range");
+            }
+            return at(k);
+        }
+
+        T& front(void) { return (*this)[0]; }
+        const T& front(void) const { return (*this)[0]; }
+        T& back(void) { return (*this)[length - 1]; }
+        const T& back(void) const { return (*this)[length - 1]; }
+
+        void push_back(const T& data) {
+            emplace_back(data);
+        }
+
+        void push_back(T&& data) {
+            emplace_back(std::move(data));
+        }
+
+        void push_front(const T& data) {
+            emplace_front(data);
+        }
+
+        void push_front(T&& data) {
+            emplace_front(std::move(data));
+        }
+
+        template <typename... Args>
+        void emplace_back(Args&&... args) {
+            if (length == capacity) {
+                //build the new element first, args may refer to an element we are about to move
+                grow(false, std::forward<Args>(args)...);
+            } else {
+                new(&at(length)) T(std::forward<Args>(args)...);
+            }
+            ++length;
+        }
+
+        template <typename... Args>
+        void emplace_front(Args&&... args) {
+            if (length == capacity) {
+                grow(true, std::forward<Args>(args)...);
+                head = capacity - 1;
+            } else {
+                uint64_t slot = (head + capacity - 1) & (capacity - 1);
+                new(buffer + slot) T(std::forward<Args>(args)...);
+                head = slot;
+            }
+            ++length;
+            --front_sequence;
+        }
+
+        void pop_back(void) {
+            if (length == 0) {
+                throw std::out_of_range("ring is empty");
+            }
+            at(length - 1).~T();
+            --length;
+        }
+
+        void pop_front(void) {
+            if (length == 0) {
+                throw std::out_of_range("ring is empty");
+            }
+            buffer[head].~T();
+            head = (head + 1) & (capacity - 1);
+            --length;
+            ++front_sequence;
+        }
+
+        iterator begin(void) { return iterator(this, front_sequence); }
+        iterator end(void) { return iterator(this, front_sequence + (int64_t)length); }
+        const_iterator begin(void) const { return const_iterator(this, front_sequence); }
+        const_iterator end(void) const { return const_iterator(this, front_sequence + (int64_t)length); }
+
+    private:
+        T& at(uint64_t k) {
+            return buffer[(head + k) & (capacity - 1)];
+        }
+
+        const T& at(uint64_t k) const {
+            return buffer[(head + k) & (capacity - 1)];
+        }
+
+        static uint64_t round_up(uint64_t n) {
+            uint64_t c = mincapacity;
+            while (c < n) {
+                c *= 2;
+            }
+            return c;
+        }
+
+        void allocate_empty(uint64_t n) {
+            buffer = (T*)operator new(sizeof(T) * n);
+            capacity = n;
+            head = 0;
+            length = 0;
+        }
+
+        /* double the storage: the old elements go (unwrapped) to the start
+         * of the new storage, the new element right after them or, for a
+         * push at the front, into the last slot. As in vector's reallocate,
+         * the old elements are moved only when that can't throw, otherwise
+         * copied, so a throw leaves the ring as it was */
+        template <typename... Args>
+        void grow(bool at_front, Args&&... args) {
+            uint64_t newcapacity = capacity == 0 ? mincapacity : capacity * 2;
+            uint64_t slot = at_front ? newcapacity - 1 : length;
+            T* newbuffer = (T*)operator new(sizeof(T) * newcapacity);
+            try {
+                new(newbuffer + slot) T(std::forward<Args>(args)...);
+            } catch (...) {
+                operator delete(newbuffer);
+                throw;
+            }
+            uint64_t k = 0;
+            try {
+                for (; k < length; k++) {
+                    new(newbuffer + k) T(std::move_if_noexcept(at(k)));
+                }
+            } catch (...) {
+                while (k > 0) {
+                    --k;
+                    newbuffer[k].~T();
+                }
+                newbuffer[slot].~T();
+                operator delete(newbuffer);
+                throw;
+            }
+            for (k = 0; k < length; k++) {
+                at(k).~T();
+            }
+            operator delete(buffer);
+            buffer = newbuffer;
+            capacity = newcapacity;
+            head = 0;
+        }
+
+        void copy(const ring<T>& that) {
+            allocate_empty(that.capacity);
+            for (uint64_t k = 0; k < that.length; k++) {
+                new(buffer + k) T{that.at(k)};
+                ++length;
+            }
+            front_sequence = that.front_sequence;
+        }
+
+        void move(ring<T>&& that) {
+            buffer = that.buffer;
+            capacity = that.capacity;
+            head = that.head;
+            length = that.length;
+            front_sequence = that.front_sequence;
+            that.buffer = nullptr;
+            that.capacity = 0;
+            that.head = 0;
+            that.length = 0;
+        }
+
+        void destroy(void) {
+            for (uint64_t k = 0; k < length; k++) {
+                at(k).~T();
+            }
+            operator delete(buffer);
+        }
+    };
+
+} //namespace epl
+
+#endif /* _RING_H_ */
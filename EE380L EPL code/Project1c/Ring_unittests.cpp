@@ -0,0 +1,154 @@
+/*
+ * Ring_unittests.cpp
+ *
+ * Tests for epl::ring, the circular buffer queue in Ring.h.
+ * main() is in Vector_PhaseA_unittests.cpp.
+ */
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include "gtest/gtest.h"
+#include "Ring.h"
+
+using epl::ring;
+
+TEST(Ring, push_pop_both_ends) {
+    ring<int> x;
+    x.push_back(2);
+    x.push_front(1);
+    x.push_back(3);
+    x.push_front(0);
+    EXPECT_EQ(4, x.size());
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(i, x[i]);
+    }
+    x.pop_front();
+    x.pop_back();
+    EXPECT_EQ(1, x.front());
+    EXPECT_EQ(2, x.back());
+    EXPECT_THROW(x[2], std::out_of_range);
+}
+
+TEST(Ring, steady_state_queue_does_not_allocate) {
+    ring<std::string> q;
+    for (int i = 0; i < 100; ++i) {
+        q.push_back(std::to_string(i));
+    }
+    uint64_t reserved = q.reserved();
+    for (int i = 100; i < 100000; ++i) {
+        EXPECT_EQ(std::to_string(i - 100), q.front());
+        q.pop_front();
+        q.push_back(std::to_string(i));
+    }
+    EXPECT_EQ(reserved, q.reserved());
+    EXPECT_EQ(100, q.size());
+
+    // and the same running backwards
+    for (int i = 0; i < 100000; ++i) {
+        q.pop_back();
+        q.push_front("x");
+    }
+    EXPECT_EQ(reserved, q.reserved());
+}
+
+TEST(Ring, grows_across_the_wrap) {
+    ring<int> x;
+    for (int i = 0; i < 5; ++i) {
+        x.push_back(i);
+    }
+    for (int i = 0; i < 3; ++i) {
+        x.pop_front();
+        x.push_back(i + 5);
+    }
+    // storage is now wrapped; push past capacity at both ends
+    for (int i = 0; i < 10; ++i) {
+        x.push_front(-1 - i);
+        x.push_back(8 + i);
+    }
+    EXPECT_EQ(-10, x[0]);
+    for (int i = 10; i < 25; ++i) {
+        EXPECT_EQ(i - 7, x[i]);
+    }
+    x.push_back(x[0]); // argument refers to an element
+    EXPECT_EQ(-10, x.back());
+}
+
+TEST(Ring, iterators) {
+    ring<int> x{1, 2, 3};
+    int sum = 0;
+    for (auto v : x) {
+        sum += v;
+    }
+    EXPECT_EQ(6, sum);
+
+    auto it = x.begin() + 1;
+    x.push_front(0);
+    for (int i = 0; i < 20; ++i) {
+        x.push_back(i); // grows, it still refers to the 2
+    }
+    EXPECT_EQ(2, *it);
+    EXPECT_EQ(24, x.end() - x.begin());
+
+    auto first = x.begin();
+    x.pop_front();
+    EXPECT_THROW(*first, epl::invalid_iterator);
+
+    ring<int> y{7};
+    x = y;
+    try {
+        *it;
+        FAIL();
+    } catch (const epl::invalid_iterator& ii) {
+        EXPECT_EQ(epl::invalid_iterator::MODERATE, ii.level);
+    }
+}
+
+TEST(Ring, move_only) {
+    ring<std::unique_ptr<int>> x;
+    for (int i = 0; i < 20; ++i) {
+        x.emplace_back(new int(i));
+        x.push_front(std::unique_ptr<int>(new int(-i)));
+    }
+    EXPECT_EQ(19, *x.back());
+    EXPECT_EQ(-19, *x.front());
+    ring<std::unique_ptr<int>> y(std::move(x));
+    EXPECT_EQ(40, y.size());
+}
+
+namespace {
+    //a copy that fails on demand, and a move that may throw, so growing has to copy
+    struct Fragile {
+        static int copies_left;
+        int value;
+        Fragile(int v) : value(v) {}
+        Fragile(const Fragile& that) : value(that.value) {
+            if (copies_left-- == 0) { throw std::runtime_error("copy failed"); }
+        }
+        Fragile(Fragile&& that) : value(that.value) { that.value = -1; }
+    };
+    int Fragile::copies_left = 0;
+}
+
+TEST(Ring, grow_keeps_the_ring_when_a_copy_throws) {
+    static_assert(std::is_nothrow_move_constructible<ring<int>>::value, "moving a ring can't throw");
+    ring<Fragile> x;
+    for (int i = 0; i < 8; ++i) {
+        x.emplace_front(i);
+    }
+    //full and wrapped; the third copy into the new storage fails
+    Fragile::copies_left = 2;
+    EXPECT_THROW(x.push_back(Fragile(8)), std::runtime_error);
+    EXPECT_EQ(8, x.size());
+    EXPECT_EQ(8, x.reserved());
+    for (int i = 0; i < 8; ++i) {
+        EXPECT_EQ(7 - i, x[i].value);
+    }
+    Fragile::copies_left = 100;
+    x.push_back(Fragile(8));
+    EXPECT_EQ(9, x.size());
+    EXPECT_EQ(7, x.front().value);
+    EXPECT_EQ(8, x.back().value);
+}
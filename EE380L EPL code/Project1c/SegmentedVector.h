@@ -0,0 +1,351 @@
+#ifndef _SEGMENTED_VECTOR_H_
+#define _SEGMENTED_VECTOR_H_
+
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+#include "SequenceIterator.h"
+
+namespace epl{
+    /*
+     * segmented_vector keeps its elements in fixed size chunks of ChunkSize
+     * elements (a power of two) reached through a directory of chunk
+     * pointers. Element k lives in chunk (offset + k) / ChunkSize, so
+     * indexing stays O(1): a shift, a mask and two loads.
+     *
+     * Growing at either end allocates one new chunk at most, and when the
+     * directory runs out of room only the pointers are copied. Elements are
+     * never moved or copied once constructed, so pointers and references to
+     * them stay valid until that element is popped, and T needs neither a
+     * copy nor a move constructor to be pushed in place.
+     *
+     * Iterators are sequence_iterators, like ring's.
+     */
+    template <typename T, uint64_t ChunkSize = 256>
+    class segmented_vector {
+        static_assert(ChunkSize > 0 && (ChunkSize & (ChunkSize - 1)) == 0,
+                      "ChunkSize must be a power of two");
+    private:
+        T** directory;
+        uint64_t directorysize; // slots in the directory
+        uint64_t firstchunk;    // directory slot of the first chunk in use
+        uint64_t chunks;        // chunks in use
+        uint64_t offset;        // position of element 0 in the first chunk
+        uint64_t length;
+
+        int64_t front_sequence{0}; // sequence number of element 0
+        uint64_t assignmentversion{0};
+
+        static constexpr uint64_t mindirectory = 8;
+
+        template <typename Container, typename Ref>
+        friend class sequence_iterator;
+
+    public:
+        using value_type = T;
+
+        using iterator = sequence_iterator<segmented_vector<T, ChunkSize>, T&>;
+        using const_iterator = sequence_iterator<const segmented_vector<T, ChunkSize>, const T&>;
+
+        segmented_vector(void) {
+            init();
+        }
+
+        explicit segmented_vector(uint64_t n) {
+            init();
+            try {
+                while (length < n) {
+                    emplace_back();
+                }
+            } catch (...) {
+                destroy();
+                throw;
+            }
+        }
+
+        segmented_vector(std::initializer_list<T> list) {
+            init();
+            try {
+                for (const T& v : list) {
+                    emplace_back(v);
+                }
+            } catch (...) {
+                destroy();
+                throw;
+            }
+        }
+
+        segmented_vector(const segmented_vector& that) {
+            copy(that);
+        }
+
+        segmented_vector(segmented_vector&& that) noexcept {
+            move(std::move(that));
+        }
+
+        segmented_vector& operator=(const segmented_vector& that) {
+            if (this != &that) {
+                destroy();
+                copy(that);
+            }
+            assignmentversion += 1;
+            return *this;
+        }
+
+        segmented_vector& operator=(segmented_vector&& that) {
+            if (this != &that) {
+                destroy();
+                move(std::move(that));
+            }
+            assignmentversion += 1;
+            that.assignmentversion += 1;
+            return *this;
+        }
+
+        ~segmented_vector(void) {
+            destroy();
+        }
+
+        uint64_t size(void) const {
+            return length;
+        }
+
+        //number of chunks currently allocated
+        uint64_t chunk_count(void) const {
+            return chunks;
+        }
+
+        T& operator[](uint64_t k) {
+            if (k >= length) {
+                throw std::out_of_range("subscript out of range");
+            }
+            return at(k);
+        }
+
+        const T& operator[](uint64_t k) const {
+            if (k >= length) {
+                throw std::out_of_range("subscript out of range");
+            }
+            return at(k);
+        }
+
+        T& front(void) { return (*this)[0]; }
+        const T& front(void) const { return (*this)[0]; }
+        T& back(void) { return (*this)[length - 1]; }
+        const T& back(void) const { return (*this)[length - 1]; }
+
+        void push_back(const T& data) {
+            emplace_back(data);
+        }
+
+        void push_back(T&& data) {
+            emplace_back(std::move(data));
+        }
+
+        void push_front(const T& data) {
+            emplace_front(data);
+        }
+
+        void push_front(T&& data) {
+            emplace_front(std::move(data));
+        }
+
+        //nothing moves, so args may safely refer to an element of this vector
+        template <typename... Args>
+        void emplace_back(Args&&... args) {
+            bool added = false;
+            if (offset + length == chunks * ChunkSize) {
+                add_chunk_back();
+                added = true;
+            }
+            try {
+                new(&at(length)) T(std::forward<Args>(args)...);
+            } catch (...) {
+                if (added) {
+                    remove_chunk_back();
+                }
+                throw;
+            }
+            ++length;
+        }
+
+        template <typename... Args>
+        void emplace_front(Args&&... args) {
+            bool added = false;
+            if (offset == 0) {
+                add_chunk_front();
+                offset = ChunkSize;
+                added = true;
+            }
+            try {
+                new(chunk_slot(offset - 1)) T(std::forward<Args>(args)...);
+            } catch (...) {
+                if (added) {
+                    remove_chunk_front();
+                    offset = 0;
+                }
+                throw;
+            }
+            --offset;
+            ++length;
+            --front_sequence;
+        }
+
+        void pop_back(void) {
+            if (length == 0) {
+                throw std::out_of_range("segmented_vector is empty");
+            }
+            at(length - 1).~T();
+            --length;
+            if (offset + length <= (chunks - 1) * ChunkSize) {
+                remove_chunk_back();
+            }
+            if (length == 0) {
+                recenter();
+            }
+        }
+
+        void pop_front(void) {
+            if (length == 0) {
+                throw std::out_of_range("segmented_vector is empty");
+            }
+            at(0).~T();
+            ++offset;
+            --length;
+            ++front_sequence;
+            if (offset == ChunkSize) {
+                remove_chunk_front();
+                offset = 0;
+            }
+            if (length == 0) {
+                recenter();
+            }
+        }
+
+        iterator begin(void) { return iterator(this, front_sequence); }
+        iterator end(void) { return iterator(this, front_sequence + (int64_t)length); }
+        const_iterator begin(void) const { return const_iterator(this, front_sequence); }
+        const_iterator end(void) const { return const_iterator(this, front_sequence + (int64_t)length); }
+
+    private:
+        //element at position p counted from the start of the first chunk
+        T* chunk_slot(uint64_t p) const {
+            return directory[firstchunk + p / ChunkSize] + (p & (ChunkSize - 1));
+        }
+
+        T& at(uint64_t k) {
+            return *chunk_slot(offset + k);
+        }
+
+        const T& at(uint64_t k) const {
+            return *chunk_slot(offset + k);
+        }
+
+        void init(void) {
+            directory = nullptr;
+            directorysize = 0;
+            firstchunk = 0;
+            chunks = 0;
+            offset = 0;
+            length = 0;
+        }
+
+        static T* new_chunk(void) {
+            return (T*)operator new(sizeof(T) * ChunkSize);
+        }
+
+        /* make room for one more chunk pointer at the front or the back. The
+         * chunks in use are centered in a directory twice their number, so
+         * a run of pushes at one end costs amortized O(1) pointer copies */
+        void grow_directory(void) {
+            uint64_t newsize = chunks * 2 + 2;
+            if (newsize < mindirectory) {
+                newsize = mindirectory;
+            }
+            T** newdirectory = new T*[newsize];
+            uint64_t newfirst = (newsize - chunks) / 2;
+            for (uint64_t c = 0; c < chunks; c++) {
+                newdirectory[newfirst + c] = directory[firstchunk + c];
+            }
+            delete[] directory;
+            directory = newdirectory;
+            directorysize = newsize;
+            firstchunk = newfirst;
+        }
+
+        void add_chunk_back(void) {
+            if (firstchunk + chunks == directorysize) {
+                grow_directory();
+            }
+            directory[firstchunk + chunks] = new_chunk();
+            ++chunks;
+        }
+
+        void add_chunk_front(void) {
+            if (firstchunk == 0) {
+                grow_directory();
+            }
+            directory[firstchunk - 1] = new_chunk();
+            --firstchunk;
+            ++chunks;
+        }
+
+        void remove_chunk_back(void) {
+            --chunks;
+            operator delete(directory[firstchunk + chunks]);
+        }
+
+        void remove_chunk_front(void) {
+            operator delete(directory[firstchunk]);
+            ++firstchunk;
+            --chunks;
+        }
+
+        /* once empty, keep a single chunk and start in its middle so the
+         * next few pushes at either end do not allocate */
+        void recenter(void) {
+            while (chunks > 1) {
+                remove_chunk_back();
+            }
+            offset = chunks == 0 ? 0 : ChunkSize / 2;
+        }
+
+        void copy(const segmented_vector& that) {
+            init();
+            try {
+                for (uint64_t k = 0; k < that.length; k++) {
+                    emplace_back(that.at(k));
+                }
+            } catch (...) {
+                destroy();
+                throw;
+            }
+            front_sequence = that.front_sequence;
+        }
+
+        void move(segmented_vector&& that) {
+            directory = that.directory;
+            directorysize = that.directorysize;
+            firstchunk = that.firstchunk;
+            chunks = that.chunks;
+            offset = that.offset;
+            length = that.length;
+            front_sequence = that.front_sequence;
+            that.init();
+        }
+
+        void destroy(void) {
+            for (uint64_t k = 0; k < length; k++) {
+                at(k).~T();
+            }
+            for (uint64_t c = 0; c < chunks; c++) {
+                operator delete(directory[firstchunk + c]);
+            }
+            delete[] directory;
+        }
+    };
+
+} //namespace epl
+
+#endif /* _SEGMENTED_VECTOR_H_ */
@@ -0,0 +1,132 @@
+/*
+ * SegmentedVector_unittests.cpp
+ *
+ * Tests for epl::segmented_vector, the chunked vector in SegmentedVector.h.
+ * main() is in Vector_PhaseA_unittests.cpp.
+ */
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "gtest/gtest.h"
+#include "SegmentedVector.h"
+
+using epl::segmented_vector;
+
+TEST(SegmentedVector, push_pop_both_ends) {
+    segmented_vector<int, 4> x;
+    for (int i = 0; i < 10; ++i) {
+        x.push_back(i);
+    }
+    for (int i = -1; i >= -10; --i) {
+        x.push_front(i);
+    }
+    EXPECT_EQ(20, x.size());
+    for (int i = 0; i < 20; ++i) {
+        EXPECT_EQ(i - 10, x[i]);
+    }
+    x.pop_front();
+    x.pop_back();
+    EXPECT_EQ(-9, x.front());
+    EXPECT_EQ(8, x.back());
+    EXPECT_THROW(x[18], std::out_of_range);
+}
+
+TEST(SegmentedVector, references_are_stable) {
+    segmented_vector<std::string, 8> x;
+    x.push_back("first");
+    std::string* first = &x[0];
+    std::vector<const std::string*> seen;
+    for (int i = 0; i < 1000; ++i) {
+        x.push_back(std::to_string(i));
+        x.push_front(std::to_string(-i));
+        seen.push_back(&x.back());
+    }
+    EXPECT_EQ(first, &x[1000]);
+    EXPECT_EQ("first", *first);
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(std::to_string(i), *seen[i]);
+    }
+}
+
+TEST(SegmentedVector, holds_immovable_types) {
+    segmented_vector<std::mutex, 4> locks;
+    for (int i = 0; i < 10; ++i) {
+        locks.emplace_back();
+        locks.emplace_front();
+    }
+    EXPECT_EQ(20, locks.size());
+    locks[7].lock();
+    locks[7].unlock();
+}
+
+TEST(SegmentedVector, frees_chunks_as_it_shrinks) {
+    segmented_vector<int, 4> x;
+    for (int i = 0; i < 16; ++i) {
+        x.push_back(i);
+    }
+    EXPECT_EQ(4, x.chunk_count());
+    for (int i = 0; i < 9; ++i) {
+        x.pop_front();
+    }
+    EXPECT_EQ(2, x.chunk_count());
+    EXPECT_EQ(9, x.front());
+    while (x.size() > 0) {
+        x.pop_back();
+    }
+    EXPECT_EQ(1, x.chunk_count());
+
+    // a queue that stays small keeps cycling through two chunks at most
+    for (int i = 0; i < 1000; ++i) {
+        x.push_back(i);
+        if (x.size() > 3) {
+            x.pop_front();
+        }
+        EXPECT_GE(2, x.chunk_count());
+    }
+}
+
+TEST(SegmentedVector, iterators) {
+    segmented_vector<int, 4> x{1, 2, 3};
+    auto p = x.begin() + 1;
+    x.push_front(0);
+    for (int i = 4; i < 20; ++i) {
+        x.push_back(i);
+    }
+    EXPECT_EQ(2, *p);
+    EXPECT_EQ(20, x.end() - x.begin());
+
+    int expected = 0;
+    for (int v : x) {
+        EXPECT_EQ(expected, v);
+        ++expected;
+    }
+
+    x.pop_front();
+    x.pop_front();
+    EXPECT_EQ(2, *p);
+    x.pop_front();
+    EXPECT_THROW(*p, epl::invalid_iterator);
+
+    segmented_vector<int, 4>::const_iterator c = x.begin();
+    x = segmented_vector<int, 4>{};
+    EXPECT_THROW(++c, epl::invalid_iterator);
+}
+
+TEST(SegmentedVector, copy_and_move) {
+    static_assert(std::is_nothrow_move_constructible<segmented_vector<std::string, 4>>::value, "moving can't throw");
+    segmented_vector<std::string, 4> x;
+    for (int i = 0; i < 10; ++i) {
+        x.push_front(std::to_string(i));
+    }
+    segmented_vector<std::string, 4> y{x};
+    EXPECT_EQ(10, y.size());
+    EXPECT_EQ("0", y.back());
+    segmented_vector<std::string, 4> z{std::move(x)};
+    EXPECT_EQ(0, x.size());
+    EXPECT_EQ("9", z.front());
+    x.push_back("again");
+    EXPECT_EQ("again", x[0]);
+}
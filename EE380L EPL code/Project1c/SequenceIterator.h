@@ -0,0 +1,142 @@
+#ifndef _SEQUENCE_ITERATOR_H_
+#define _SEQUENCE_ITERATOR_H_
+
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+
+#include "Vector.h"
+
+namespace epl{
+    /*
+     * Iterator for the containers that never move their elements in index
+     * space (ring, segmented_vector, static_vector). It remembers the
+     * sequence number of its element (how many elements were in front of it
+     * when it was created, minus pops), so it survives pushes, pops at the
+     * other end and growth. It throws invalid_iterator like vector's
+     * iterators: SEVERE when its element was popped, MODERATE when the
+     * container was assigned to.
+     *
+     * The container has to befriend sequence_iterator and provide
+     * value_type, assignmentversion, front_sequence, length and at(k).
+     * Everything is constexpr, so a container that is constexpr itself
+     * (static_vector) can be iterated at compile time.
+     */
+    template <typename Container, typename Ref>
+    class sequence_iterator {
+    private:
+        Container* container;
+        int64_t sequence;
+        uint64_t assignmentversion;
+    public:
+        using value_type = typename std::remove_const<Container>::type::value_type;
+        using iterator_category = std::random_access_iterator_tag;
+        using difference_type = int64_t;
+        using pointer = typename std::remove_reference<Ref>::type*;
+        using reference = Ref;
+
+        constexpr sequence_iterator(Container* r, int64_t sequence)
+            : container(r), sequence(sequence), assignmentversion(r->assignmentversion) {}
+
+        //a const_iterator can be made from an iterator
+        template <typename C2, typename R2>
+        constexpr sequence_iterator(const sequence_iterator<C2, R2>& that)
+            : container(that.container), sequence(that.sequence), assignmentversion(that.assignmentversion) {}
+
+        constexpr void checkvalidation(bool dereference = false) const {
+            if (this->assignmentversion != this->container->assignmentversion) {
+                throw invalid_iterator{invalid_iterator::MODERATE};
+            }
+            int64_t index = this->sequence - this->container->front_sequence;
+            if (dereference && (index < 0 || index >= (int64_t)this->container->length)) {
+                throw invalid_iterator{invalid_iterator::SEVERE};
+            }
+        }
+
+        constexpr Ref operator*(void) const {
+            checkvalidation(true);
+            return container->at(sequence - container->front_sequence);
+        }
+
+        constexpr Ref operator[](int64_t n) const {
+            return *(*this + n);
+        }
+
+        constexpr bool operator<(const sequence_iterator& that) const {
+            checkvalidation();
+            that.checkvalidation();
+            return this->sequence < that.sequence;
+        }
+
+        constexpr bool operator==(const sequence_iterator& that) const {
+            checkvalidation();
+            that.checkvalidation();
+            return this->sequence == that.sequence;
+        }
+
+        //std::rel_ops would do, but it is not constexpr
+        constexpr bool operator!=(const sequence_iterator& that) const {
+            return !(*this == that);
+        }
+
+        constexpr sequence_iterator& operator++(void) {
+            checkvalidation();
+            ++sequence;
+            return *this;
+        }
+
+        constexpr sequence_iterator operator++(int) {
+            sequence_iterator i{*this};
+            this->operator++();
+            return i;
+        }
+
+        constexpr sequence_iterator& operator--(void) {
+            checkvalidation();
+            --sequence;
+            return *this;
+        }
+
+        constexpr sequence_iterator operator--(int) {
+            sequence_iterator i{*this};
+            this->operator--();
+            return i;
+        }
+
+        constexpr sequence_iterator& operator+=(int64_t n) {
+            checkvalidation();
+            sequence += n;
+            return *this;
+        }
+
+        constexpr sequence_iterator& operator-=(int64_t n) {
+            return *this += -n;
+        }
+
+        constexpr sequence_iterator operator+(int64_t n) const {
+            sequence_iterator i{*this};
+            return i += n;
+        }
+
+        friend constexpr sequence_iterator operator+(int64_t n, const sequence_iterator& i) {
+            return i + n;
+        }
+
+        constexpr sequence_iterator operator-(int64_t n) const {
+            sequence_iterator i{*this};
+            return i -= n;
+        }
+
+        constexpr int64_t operator-(const sequence_iterator& that) const {
+            checkvalidation();
+            that.checkvalidation();
+            return this->sequence - that.sequence;
+        }
+
+        template <typename C2, typename R2>
+        friend class sequence_iterator;
+    };
+
+} //namespace epl
+
+#endif /* _SEQUENCE_ITERATOR_H_ */
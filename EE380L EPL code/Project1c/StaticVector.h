@@ -0,0 +1,219 @@
+#ifndef _STATIC_VECTOR_H_
+#define _STATIC_VECTOR_H_
+
+#include <cstdint>
+#include <initializer_list>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "SequenceIterator.h"
+
+namespace epl{
+    /*
+     * Element storage for static_vector. Trivial types live in a plain
+     * array, which constexpr code may write to (C++14 has no constexpr
+     * placement new), so a static_vector of them is a literal type. Every
+     * other type gets raw aligned storage that elements are built in and
+     * destroyed one by one.
+     */
+    template <typename T, uint64_t N,
+              bool Literal = std::is_trivially_default_constructible<T>::value
+                          && std::is_trivially_destructible<T>::value>
+    class static_vector_storage {
+    protected:
+        T elements[N]{};
+        uint64_t length{0};
+
+        template <typename... Args>
+        constexpr void construct(uint64_t k, Args&&... args) {
+            elements[k] = T(std::forward<Args>(args)...);
+        }
+        constexpr void destroy(uint64_t) {}
+        constexpr T& at(uint64_t k) { return elements[k]; }
+        constexpr const T& at(uint64_t k) const { return elements[k]; }
+    };
+
+    template <typename T, uint64_t N>
+    class static_vector_storage<T, N, false> {
+    protected:
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type elements[N];
+        uint64_t length{0};
+
+        static_vector_storage(void) = default;
+        static_vector_storage(const static_vector_storage&) = delete;
+        static_vector_storage& operator=(const static_vector_storage&) = delete;
+
+        ~static_vector_storage(void) {
+            for (uint64_t k = 0; k < length; k++) {
+                destroy(k);
+            }
+        }
+
+        template <typename... Args>
+        void construct(uint64_t k, Args&&... args) {
+            new(&elements[k]) T(std::forward<Args>(args)...);
+        }
+        void destroy(uint64_t k) { at(k).~T(); }
+        T& at(uint64_t k) { return *reinterpret_cast<T*>(&elements[k]); }
+        const T& at(uint64_t k) const { return *reinterpret_cast<const T*>(&elements[k]); }
+    };
+
+    /*
+     * static_vector holds up to N elements inline: no allocation, ever.
+     * Pushing onto a full static_vector throws out_of_range.
+     *
+     * Nothing moves, so iterators (sequence_iterators, like ring's) are only
+     * invalidated the way epl::vector's are by pops and assignment: SEVERE
+     * once their element is popped, MODERATE after the vector is assigned to.
+     *
+     * For trivial T every member is constexpr, so tables can be built at
+     * compile time:
+     *     constexpr static_vector<int, 8> squares = make_squares();
+     */
+    template <typename T, uint64_t N>
+    class static_vector : private static_vector_storage<T, N> {
+        static_assert(N > 0, "static_vector needs room for at least one element");
+    private:
+        using storage = static_vector_storage<T, N>;
+        using storage::length;
+        using storage::construct;
+        using storage::destroy;
+        using storage::at;
+
+        int64_t front_sequence{0}; // there is no push_front, so this never changes
+        uint64_t assignmentversion{0};
+
+        template <typename Container, typename Ref>
+        friend class sequence_iterator;
+
+    public:
+        using value_type = T;
+
+        using iterator = sequence_iterator<static_vector<T, N>, T&>;
+        using const_iterator = sequence_iterator<const static_vector<T, N>, const T&>;
+
+        constexpr static_vector(void) = default;
+
+        constexpr static_vector(std::initializer_list<T> list) {
+            if (list.size() > N) {
+                throw std::out_of_range("too many elements for static_vector");
+            }
+            for (const T& v : list) {
+                construct(length, v);
+                ++length;
+            }
+        }
+
+        constexpr static_vector(const static_vector& that) {
+            copy(that);
+        }
+
+        constexpr static_vector(static_vector&& that) {
+            move(std::move(that));
+        }
+
+        constexpr static_vector& operator=(const static_vector& that) {
+            if (this != &that) {
+                clear();
+                copy(that);
+            }
+            assignmentversion += 1;
+            return *this;
+        }
+
+        constexpr static_vector& operator=(static_vector&& that) {
+            if (this != &that) {
+                clear();
+                move(std::move(that));
+            }
+            assignmentversion += 1;
+            return *this;
+        }
+
+        constexpr uint64_t size(void) const {
+            return length;
+        }
+
+        static constexpr uint64_t capacity(void) {
+            return N;
+        }
+
+        constexpr T& operator[](uint64_t k) {
+            if (k >= length) {
+                throw std::out_of_range("subscript out of range");
+            }
+            return at(k);
+        }
+
+        constexpr const T& operator[](uint64_t k) const {
+            if (k >= length) {
+                throw std::out_of_range("subscript out of range");
+            }
+            return at(k);
+        }
+
+        constexpr T& front(void) { return (*this)[0]; }
+        constexpr const T& front(void) const { return (*this)[0]; }
+        constexpr T& back(void) { return (*this)[length - 1]; }
+        constexpr const T& back(void) const { return (*this)[length - 1]; }
+
+        constexpr void push_back(const T& data) {
+            emplace_back(data);
+        }
+
+        constexpr void push_back(T&& data) {
+            emplace_back(std::move(data));
+        }
+
+        template <typename... Args>
+        constexpr void emplace_back(Args&&... args) {
+            if (length == N) {
+                throw std::out_of_range("static_vector is full");
+            }
+            construct(length, std::forward<Args>(args)...);
+            ++length;
+        }
+
+        constexpr void pop_back(void) {
+            if (length == 0) {
+                throw std::out_of_range("static_vector is empty");
+            }
+            --length;
+            destroy(length);
+        }
+
+        constexpr void clear(void) {
+            while (length > 0) {
+                --length;
+                destroy(length);
+            }
+        }
+
+        constexpr iterator begin(void) { return iterator(this, 0); }
+        constexpr iterator end(void) { return iterator(this, (int64_t)length); }
+        constexpr const_iterator begin(void) const { return const_iterator(this, 0); }
+        constexpr const_iterator end(void) const { return const_iterator(this, (int64_t)length); }
+
+    private:
+        constexpr void copy(const static_vector& that) {
+            for (uint64_t k = 0; k < that.length; k++) {
+                construct(k, that.at(k));
+                ++length;
+            }
+        }
+
+        //there is no storage to steal: the elements move one by one, then that is emptied
+        constexpr void move(static_vector&& that) {
+            for (uint64_t k = 0; k < that.length; k++) {
+                construct(k, std::move(that.at(k)));
+                ++length;
+            }
+            that.clear();
+        }
+    };
+
+} //namespace epl
+
+#endif /* _STATIC_VECTOR_H_ */
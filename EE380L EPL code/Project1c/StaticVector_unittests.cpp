@@ -0,0 +1,105 @@
+/*
+ * StaticVector_unittests.cpp
+ *
+ * Tests for epl::static_vector, the fixed capacity vector in StaticVector.h.
+ * main() is in Vector_PhaseA_unittests.cpp.
+ */
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "gtest/gtest.h"
+#include "StaticVector.h"
+
+using epl::static_vector;
+
+namespace {
+    constexpr static_vector<int, 8> squares(void) {
+        static_vector<int, 8> v;
+        for (int i = 0; i < 8; ++i) {
+            v.push_back(i * i);
+        }
+        return v;
+    }
+
+    constexpr int sum(const static_vector<int, 8>& v) {
+        int total = 0;
+        for (int x : v) {
+            total += x;
+        }
+        return total;
+    }
+
+    //the N-queens board: the column of the queen in each row
+    constexpr static_vector<int, 8> first_queens(void) {
+        static_vector<int, 8> columns;
+        int col = 0;
+        while (columns.size() < 8) {
+            bool safe = col < 8;
+            for (uint64_t row = 0; safe && row < columns.size(); ++row) {
+                int d = (int)(columns.size() - row);
+                safe = columns[row] != col && columns[row] - col != d && col - columns[row] != d;
+            }
+            if (safe) {
+                columns.push_back(col);
+                col = 0;
+            } else if (col < 8) {
+                ++col;
+            } else { //backtrack
+                col = columns.back() + 1;
+                columns.pop_back();
+            }
+        }
+        return columns;
+    }
+}
+
+TEST(StaticVector, constexpr_tables) {
+    constexpr static_vector<int, 8> table = squares();
+    static_assert(table.size() == 8, "built at compile time");
+    static_assert(table[3] == 9, "built at compile time");
+    static_assert(sum(table) == 140, "iterated at compile time");
+    static_assert(static_vector<int, 8>::capacity() == 8, "");
+
+    constexpr static_vector<int, 8> queens = first_queens();
+    static_assert(queens[0] == 0 && queens[1] == 4 && queens[7] == 3, "solved at compile time");
+    EXPECT_EQ(5, queens[3]);
+}
+
+TEST(StaticVector, push_pop) {
+    static_vector<std::string, 4> x{"a", "b"};
+    x.push_back("c");
+    x.emplace_back(2, 'd');
+    EXPECT_EQ(4, x.size());
+    EXPECT_EQ("dd", x.back());
+    EXPECT_THROW(x.push_back("e"), std::out_of_range);
+    x.pop_back();
+    EXPECT_EQ("c", x.back());
+    EXPECT_THROW(x[3], std::out_of_range);
+    x.clear();
+    EXPECT_THROW(x.pop_back(), std::out_of_range);
+}
+
+TEST(StaticVector, move_only_elements) {
+    static_vector<std::unique_ptr<int>, 4> x;
+    x.emplace_back(new int(1));
+    x.push_back(std::unique_ptr<int>(new int(2)));
+    static_vector<std::unique_ptr<int>, 4> y(std::move(x));
+    EXPECT_EQ(0, x.size());
+    EXPECT_EQ(2, *y[1]);
+}
+
+TEST(StaticVector, iterators) {
+    static_vector<int, 8> x{1, 2, 3};
+    auto p = x.begin() + 2;
+    x.push_back(4);
+    EXPECT_EQ(3, *p);
+    EXPECT_EQ(4, x.end() - x.begin());
+    x.pop_back();
+    x.pop_back();
+    EXPECT_THROW(*p, epl::invalid_iterator);
+
+    static_vector<int, 8>::const_iterator c = x.begin();
+    x = static_vector<int, 8>{7};
+    EXPECT_THROW(*c, epl::invalid_iterator);
+}
@@ -5,6 +5,10 @@
 #include <stdexcept>
 #include <utility>
 
+#ifdef EPL_DEBUG_CONCURRENCY
+#include <atomic>
+#endif
+
 //Utility gives std::rel_ops which will fill in relational
 //iterator operations so long as you provide the
 //operators discussed in class.  In any case, ensure that
@@ -31,6 +35,47 @@ namespace epl{
         }
     };
     
+#ifdef EPL_DEBUG_CONCURRENCY
+    /*
+     * With EPL_DEBUG_CONCURRENCY the vector's version counters are atomic:
+     * a mutation publishes its new version with a release increment and an
+     * iterator in another thread reads it with an acquire load, so a stress
+     * test sees invalid_iterator instead of racing on a plain uint64_t.
+     * Without the macro version_counter is just uint64_t.
+     */
+    class version_counter {
+    private:
+        std::atomic<uint64_t> count;
+    public:
+        version_counter(uint64_t c = 0) : count(c) {}
+        version_counter(const version_counter& that) : count(that.load()) {}
+        version_counter& operator=(const version_counter& that) {
+            count.store(that.load(), std::memory_order_release);
+            return *this;
+        }
+
+        uint64_t load(void) const {
+            return count.load(std::memory_order_acquire);
+        }
+        operator uint64_t() const {
+            return load();
+        }
+
+        version_counter& operator+=(uint64_t n) {
+            count.fetch_add(n, std::memory_order_release);
+            return *this;
+        }
+        version_counter& operator++(void) {
+            return *this += 1;
+        }
+        uint64_t operator++(int) {
+            return count.fetch_add(1, std::memory_order_release);
+        }
+    };
+#else
+    using version_counter = uint64_t;
+#endif
+
     template <typename T>
     class vector {
     private:
@@ -40,14 +85,16 @@ namespace epl{
         uint64_t length;
         uint64_t capacity;
         
-        uint64_t version{0};
-        uint64_t assignmentversion{0};
-        uint64_t push_fronts{0};
-        uint64_t pop_fronts{0};
+        version_counter version{0};
+        version_counter assignmentversion{0};
+        version_counter push_fronts{0};
+        version_counter pop_fronts{0};
         
         static constexpr uint64_t mincapacity = 8;
         
     public:
+        using value_type = T;
+        
         class iterator;
         class const_iterator;
         
@@ -502,34 +549,6 @@ namespace epl{
             }
         }
         
-        template <typename... Args>
-        void emplace_back(Args&&... args) {
-            if (last - head == capacity - 1) {//need reallocation
-                T* newhead = (T*)operator new(sizeof(T) * 2 * capacity);
-                uint64_t pace = first - head;
-                last = newhead + pace + length - 1;
-                last++;
-                new(last) T{std::forward<Args...>(args...)};//maybe a problem?
-                for (int i = 0; i < length; i++) {
-                    new(newhead + i + pace) T{std::move(first[i])};
-                }
-                for (int i = 0; i < length; i++) {
-                    first[i].~T();
-                }
-                
-                operator delete(head);
-                capacity *= 2;
-                head = newhead;
-                first = pace + head;
-                length++;
-                
-            } else {
-                last++;
-                new(last) T{std::forward<Args...>(args...)};//too much elments, vector can't contain?
-                length++;// how to reset my lenth?
-            }
-        }
-        
         template <typename RAI>
         void iterator_initialize_vector(RAI b, RAI e, std::random_access_iterator_tag t) {
             uint64_t size = e - b;//do we need to initialize e?
@@ -644,7 +663,7 @@ namespace epl{
             copy(that);
         }
         //move constructor
-        vector(vector<T>&& that) {
+        vector(vector<T>&& that) noexcept {
             move(std::move(that));
             //move(that); //why this would be an error
             that.version += 1;
@@ -702,126 +721,56 @@ namespace epl{
         
         //push_back copy construct
         void push_back(const T& data) {
-            if (last - head == capacity - 1) {
-                T* newhead = (T*)operator new(sizeof(T) * 2 * capacity);
-                uint64_t pace = first - head;
-                last = newhead + pace + length - 1;
-                last++;
-                new(last) T{data};
-                for (int i = 0; i < length; i++) {
-                    new(newhead + i + pace) T{std::move(first[i])};
-                }
-                for (int i = 0; i < length; i++) {
-                    first[i].~T();
-                }
-                
-                operator delete(head);
-                capacity *= 2;
-                head = newhead;
-                first = pace + head;
-                length++;
-                
-            } else {
-                last++;
-                new(last) T{data};//copy constructor
-                length++;
-            }
-            
-            this->version += 1;
+            emplace_back(data);
         }
         
         //push_back move construct
         void push_back(T&& data) {
-            if (last - head == capacity - 1) {
-                T* newhead = (T*)operator new(sizeof(T) * 2 * capacity);
-                uint64_t pace = first - head;
-                last = newhead + pace + length - 1;
-                last++;
-                new(last) T{std::move(data)};
-                for (int i = 0; i < length; i++) {
-                    new(newhead + i + pace) T{std::move(first[i])};
-                }
-                for (int i = 0; i < length; i++) {
-                    first[i].~T();
-                }
-                
-                operator delete(head);
-                capacity *= 2;
-                head = newhead;
-                first = pace + head;
-                length++;
-                
-            } else {
-                last++;
-                new(last) T{std::move(data)};//copy constructor
-                length++;
-            }
-            this->version += 1;
+            emplace_back(std::move(data));
         }
         
         //push_front copy construct
         void push_front(const T& data) {
-            if (first == head && last == head - 1) {//the vector is empty
-                new(first) T{data};
-                last++;
-                length++;
+            emplace_front(data);
+        }
+        
+        //push_front move contruct
+        void push_front(T&& data) {
+            emplace_front(std::move(data));
+        }
+        
+        //the new element is built before anything else changes, so if that
+        //throws (or a reallocation does) the vector is left as it was
+        template <typename... Args>
+        void emplace_back(Args&&... args) {
+            if (last - head == capacity - 1) {//need reallocation
+                uint64_t pace = first - head;
+                reallocate(2 * capacity, pace, pace + length, std::forward<Args>(args)...);
+                first = head + pace;
+                last = first + length;
             } else {
-                if (first == head) {//the vector's front capacity is 0
-                    T* newhead = (T*)operator new(sizeof(T) * capacity * 2);
-                    new(newhead + capacity - 1) T{data};
-                    for (int i = 0; i < length; i++) {
-                        new(newhead + i + capacity) T{std::move(first[i])};
-                    }
-                    
-                    for (int i = 0; i < length; i++) {
-                        first[i].~T();
-                    }
-                    operator delete(head);
-                    head = newhead;
-                    first = head + capacity - 1;
-                    last = first + length - 1;
-                    last++;
-                    capacity *= 2;
-                    length++;
-                } else if (first > head) {//the vector has available front capacity
-                    first--;
-                    new(first) T{data};
-                    length++;
-                }
+                new(last + 1) T(std::forward<Args>(args)...);
+                last++;
             }
+            length++;
             this->version += 1;
-            push_fronts++;
         }
-        //push_front move contruct
-        void push_front(T&& data) {
+        
+        template <typename... Args>
+        void emplace_front(Args&&... args) {
             if (first == head && last == head - 1) {//the vector is empty
-                new(first) T{std::move(data)};
+                new(first) T(std::forward<Args>(args)...);
                 last++;
-                length++;
-            } else {
-                if (first == head) {//the vector's front capacity is 0
-                    T* newhead = (T*)operator new(sizeof(T) * capacity * 2);
-                    new(newhead + capacity - 1) T{std::move(data)};
-                    for (int i = 0; i < length; i++) {
-                        new(newhead + i + capacity) T{std::move(first[i])};
-                    }
-                    
-                    for (int i = 0; i < length; i++) {
-                        first[i].~T();
-                    }
-                    operator delete(head);
-                    head = newhead;
-                    first = head + capacity - 1;
-                    last = first + length - 1;
-                    last++;
-                    capacity *= 2;
-                    length++;
-                } else if (first > head) {//the vector has available front capacity
-                    first--;
-                    new(first) T{std::move(data)};
-                    length++;
-                }
-            }
+            } else if (first == head) {//the vector's front capacity is 0
+                uint64_t oldcapacity = capacity;
+                reallocate(2 * capacity, oldcapacity, oldcapacity - 1, std::forward<Args>(args)...);
+                first = head + oldcapacity - 1;
+                last = first + length;
+            } else {//the vector has available front capacity
+                new(first - 1) T(std::forward<Args>(args)...);
+                first--;
+            }
+            length++;
             this->version += 1;
             push_fronts++;
         }
@@ -849,6 +798,44 @@ namespace epl{
             pop_fronts++;
         }
     private:
+        /* replace the storage with newcapacity elements: the new element is
+         * built at index slot first (args may refer to an old element), then
+         * the old elements go to index offset on. They are moved only when
+         * their move constructor cannot throw, otherwise copied, so until the
+         * old storage is released nothing has changed (move only types are
+         * moved regardless). head and capacity are updated, the caller fixes
+         * first and last */
+        template <typename... Args>
+        void reallocate(uint64_t newcapacity, uint64_t offset, uint64_t slot, Args&&... args) {
+            T* newhead = (T*)operator new(sizeof(T) * newcapacity);
+            try {
+                new(newhead + slot) T(std::forward<Args>(args)...);
+            } catch (...) {
+                operator delete(newhead);
+                throw;
+            }
+            uint64_t i = 0;
+            try {
+                for (; i < length; i++) {
+                    new(newhead + offset + i) T(std::move_if_noexcept(first[i]));
+                }
+            } catch (...) {
+                while (i > 0) {
+                    --i;
+                    newhead[offset + i].~T();
+                }
+                newhead[slot].~T();
+                operator delete(newhead);
+                throw;
+            }
+            for (i = 0; i < length; i++) {
+                first[i].~T();
+            }
+            operator delete(head);
+            head = newhead;
+            capacity = newcapacity;
+        }
+        
         void copy(const vector<T>& that) {
             this->capacity = that.capacity;//test that.capacity==0?
             this->length = that.length;
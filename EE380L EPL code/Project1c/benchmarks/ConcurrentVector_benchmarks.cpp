@@ -0,0 +1,82 @@
+/*
+ * ConcurrentVector_benchmarks.cpp
+ *
+ * Contention benchmark for epl::concurrent_vector: 1 to 64 threads append
+ * a fixed total number of elements into one shared container. The same
+ * load goes through std::vector and epl::vector behind a std::mutex, which
+ * is what producer threads did before. Times are wall clock, per element.
+ */
+
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "ConcurrentVector.h"
+#include "Vector.h"
+
+namespace {
+    //a 64 byte trivially copyable payload
+    struct Block {
+        uint64_t word[8];
+        Block(uint64_t i = 0) { for (auto& w : word) { w = i; } }
+    };
+
+    //a vector that producers share by taking a lock for every push
+    template <typename C>
+    class locked {
+    public:
+        using value_type = typename C::value_type;
+
+        void push_back(const value_type& v) {
+            std::lock_guard<std::mutex> guard(lock);
+            data.push_back(v);
+        }
+
+        uint64_t size(void) {
+            std::lock_guard<std::mutex> guard(lock);
+            return data.size();
+        }
+
+    private:
+        std::mutex lock;
+        C data;
+    };
+
+    constexpr uint64_t total = 1 << 20;
+} //namespace
+
+template <typename C>
+void Append(benchmark::State& state) {
+    const uint64_t threads = state.range(0);
+    const uint64_t per_thread = total / threads;
+    for (auto _ : state) {
+        C c;
+        std::vector<std::thread> producers;
+        for (uint64_t t = 0; t < threads; ++t) {
+            producers.emplace_back([&c, t, per_thread] {
+                for (uint64_t i = 0; i < per_thread; ++i) {
+                    c.push_back(typename C::value_type(t * per_thread + i));
+                }
+            });
+        }
+        for (auto& p : producers) {
+            p.join();
+        }
+        benchmark::DoNotOptimize(c.size());
+    }
+    state.SetItemsProcessed(state.iterations() * per_thread * threads);
+}
+
+#define EPL_CONTENTION_BENCHMARK(C) \
+    BENCHMARK_TEMPLATE(Append, C)->RangeMultiplier(2)->Range(1, 64)->UseRealTime()->Unit(benchmark::kMillisecond)
+
+EPL_CONTENTION_BENCHMARK(epl::concurrent_vector<uint64_t>);
+EPL_CONTENTION_BENCHMARK(locked<std::vector<uint64_t>>);
+EPL_CONTENTION_BENCHMARK(locked<epl::vector<uint64_t>>);
+EPL_CONTENTION_BENCHMARK(epl::concurrent_vector<Block>);
+EPL_CONTENTION_BENCHMARK(locked<std::vector<Block>>);
+EPL_CONTENTION_BENCHMARK(locked<epl::vector<Block>>);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,281 @@
+/*
+ * Vector_benchmarks.cpp
+ *
+ * Google Benchmark cases for epl::vector, epl::ring and epl::segmented_vector,
+ * each run against std::vector and std::deque with the same element types and
+ * sizes. Cases that a container cannot do in constant time (push_front on
+ * std::vector) are not registered.
+ */
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "Ring.h"
+#include "SegmentedVector.h"
+#include "Vector.h"
+
+namespace {
+    //a 64 byte trivially copyable payload
+    struct Block {
+        uint64_t word[8];
+    };
+
+    template <typename T> T make(uint64_t i);
+    template <> int make<int>(uint64_t i) { return (int)i; }
+    template <> double make<double>(uint64_t i) { return (double)i; }
+    template <> std::string make<std::string>(uint64_t i) { return std::string(32, (char)('a' + i % 26)); }
+    template <> Block make<Block>(uint64_t i) { Block b; for (auto& w : b.word) { w = i; } return b; }
+
+    //the containers disagree on how to pop from an empty end and how to iterate,
+    //so every case goes through the common subset: push/pop at the ends, [] and size
+    template <typename C>
+    C filled(uint64_t n) {
+        C c;
+        for (uint64_t i = 0; i < n; ++i) {
+            c.push_back(make<typename C::value_type>(i));
+        }
+        return c;
+    }
+
+    //a move only element owning a 512 byte payload; it counts its moves, and
+    //the deleted copy constructor proves no container copies it
+    struct Heavy {
+        static uint64_t moves;
+        std::unique_ptr<uint64_t[]> payload;
+
+        Heavy(uint64_t i, uint64_t words) : payload(new uint64_t[words]) { payload[0] = i; }
+        Heavy(const Heavy&) = delete;
+        Heavy(Heavy&& that) noexcept : payload(std::move(that.payload)) { ++moves; }
+        Heavy& operator=(Heavy&& that) noexcept { payload = std::move(that.payload); ++moves; return *this; }
+    };
+    uint64_t Heavy::moves = 0;
+
+    constexpr int64_t min_size = 64;
+    constexpr int64_t max_size = 1 << 18;
+} //namespace
+
+template <typename C>
+void PushBack(benchmark::State& state) {
+    const uint64_t n = state.range(0);
+    for (auto _ : state) {
+        C c;
+        for (uint64_t i = 0; i < n; ++i) {
+            c.push_back(make<typename C::value_type>(i));
+        }
+        benchmark::DoNotOptimize(c[n - 1]);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename C>
+void PushFront(benchmark::State& state) {
+    const uint64_t n = state.range(0);
+    for (auto _ : state) {
+        C c;
+        for (uint64_t i = 0; i < n; ++i) {
+            c.push_front(make<typename C::value_type>(i));
+        }
+        benchmark::DoNotOptimize(c[n - 1]);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename C>
+void EmplaceBack(benchmark::State& state) {
+    const uint64_t n = state.range(0);
+    const typename C::value_type v = make<typename C::value_type>(7);
+    for (auto _ : state) {
+        C c;
+        for (uint64_t i = 0; i < n; ++i) {
+            c.emplace_back(v);
+        }
+        benchmark::DoNotOptimize(c[n - 1]);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename C>
+void PopBack(benchmark::State& state) {
+    const uint64_t n = state.range(0);
+    for (auto _ : state) {
+        state.PauseTiming();
+        C c = filled<C>(n);
+        state.ResumeTiming();
+        for (uint64_t i = 0; i < n; ++i) {
+            c.pop_back();
+        }
+        benchmark::DoNotOptimize(c.size());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename C>
+void PopFront(benchmark::State& state) {
+    const uint64_t n = state.range(0);
+    for (auto _ : state) {
+        state.PauseTiming();
+        C c = filled<C>(n);
+        state.ResumeTiming();
+        for (uint64_t i = 0; i < n; ++i) {
+            c.pop_front();
+        }
+        benchmark::DoNotOptimize(c.size());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+//FIFO use: the size stays at n while n elements flow through
+template <typename C>
+void Queue(benchmark::State& state) {
+    const uint64_t n = state.range(0);
+    C c = filled<C>(n);
+    uint64_t i = 0;
+    for (auto _ : state) {
+        c.push_back(make<typename C::value_type>(i++));
+        c.pop_front();
+    }
+    benchmark::DoNotOptimize(c[0]);
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <typename C>
+void RandomAccess(benchmark::State& state) {
+    const uint64_t n = state.range(0);
+    C c = filled<C>(n);
+    uint64_t k = 1;
+    for (auto _ : state) {
+        k = (k * 6364136223846793005ull + 1442695040888963407ull);
+        benchmark::DoNotOptimize(c[(k >> 33) % n]);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <typename C>
+void Iterate(benchmark::State& state) {
+    const uint64_t n = state.range(0);
+    C c = filled<C>(n);
+    for (auto _ : state) {
+        for (auto& v : c) {
+            benchmark::DoNotOptimize(v);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename C>
+void Copy(benchmark::State& state) {
+    const uint64_t n = state.range(0);
+    C c = filled<C>(n);
+    for (auto _ : state) {
+        C d(c);
+        benchmark::DoNotOptimize(d[n - 1]);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename C>
+void Move(benchmark::State& state) {
+    const uint64_t n = state.range(0);
+    C c = filled<C>(n);
+    for (auto _ : state) {
+        C d(std::move(c));
+        c = std::move(d);
+        benchmark::DoNotOptimize(c[n - 1]);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+//grow to n, shrink to zero, grow again: measures what capacity is kept
+template <typename C>
+void Sawtooth(benchmark::State& state) {
+    const uint64_t n = state.range(0);
+    for (auto _ : state) {
+        C c;
+        for (int round = 0; round < 2; ++round) {
+            for (uint64_t i = 0; i < n; ++i) {
+                c.push_back(make<typename C::value_type>(i));
+            }
+            for (uint64_t i = 0; i < n; ++i) {
+                c.pop_back();
+            }
+        }
+        benchmark::DoNotOptimize(c.size());
+    }
+    state.SetItemsProcessed(state.iterations() * 4 * n);
+}
+
+//emplace move only elements at the back, with several constructor arguments
+template <typename C>
+void EmplaceHeavy(benchmark::State& state) {
+    const uint64_t n = state.range(0);
+    Heavy::moves = 0;
+    for (auto _ : state) {
+        C c;
+        for (uint64_t i = 0; i < n; ++i) {
+            c.emplace_back(i, 64);
+        }
+        benchmark::DoNotOptimize(c[n - 1].payload[0]);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+    state.counters["moves_per_element"] = (double)Heavy::moves / (state.iterations() * n);
+}
+
+//the same, alternating between the two ends
+template <typename C>
+void EmplaceHeavyBothEnds(benchmark::State& state) {
+    const uint64_t n = state.range(0);
+    Heavy::moves = 0;
+    for (auto _ : state) {
+        C c;
+        for (uint64_t i = 0; i < n; ++i) {
+            if (i % 2 == 0) {
+                c.emplace_back(i, 64);
+            } else {
+                c.emplace_front(i, 64);
+            }
+        }
+        benchmark::DoNotOptimize(c[0].payload[0]);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+    state.counters["moves_per_element"] = (double)Heavy::moves / (state.iterations() * n);
+}
+
+#define EPL_BENCHMARK(Case, T)                                                              \
+    BENCHMARK_TEMPLATE(Case, epl::vector<T>)->RangeMultiplier(8)->Range(min_size, max_size); \
+    BENCHMARK_TEMPLATE(Case, epl::ring<T>)->RangeMultiplier(8)->Range(min_size, max_size);   \
+    BENCHMARK_TEMPLATE(Case, epl::segmented_vector<T>)->RangeMultiplier(8)->Range(min_size, max_size); \
+    BENCHMARK_TEMPLATE(Case, std::vector<T>)->RangeMultiplier(8)->Range(min_size, max_size); \
+    BENCHMARK_TEMPLATE(Case, std::deque<T>)->RangeMultiplier(8)->Range(min_size, max_size)
+
+#define EPL_BENCHMARK_FRONT(Case, T)                                                        \
+    BENCHMARK_TEMPLATE(Case, epl::vector<T>)->RangeMultiplier(8)->Range(min_size, max_size); \
+    BENCHMARK_TEMPLATE(Case, epl::ring<T>)->RangeMultiplier(8)->Range(min_size, max_size);   \
+    BENCHMARK_TEMPLATE(Case, epl::segmented_vector<T>)->RangeMultiplier(8)->Range(min_size, max_size); \
+    BENCHMARK_TEMPLATE(Case, std::deque<T>)->RangeMultiplier(8)->Range(min_size, max_size)
+
+#define EPL_BENCHMARK_ALL(T)          \
+    EPL_BENCHMARK(PushBack, T);       \
+    EPL_BENCHMARK_FRONT(PushFront, T); \
+    EPL_BENCHMARK(EmplaceBack, T);    \
+    EPL_BENCHMARK(PopBack, T);        \
+    EPL_BENCHMARK_FRONT(PopFront, T); \
+    EPL_BENCHMARK_FRONT(Queue, T);    \
+    EPL_BENCHMARK(RandomAccess, T);   \
+    EPL_BENCHMARK(Iterate, T);        \
+    EPL_BENCHMARK(Copy, T);           \
+    EPL_BENCHMARK(Move, T);           \
+    EPL_BENCHMARK(Sawtooth, T)
+
+EPL_BENCHMARK_ALL(int);
+EPL_BENCHMARK_ALL(double);
+EPL_BENCHMARK_ALL(std::string);
+EPL_BENCHMARK_ALL(Block);
+EPL_BENCHMARK(EmplaceHeavy, Heavy);
+EPL_BENCHMARK_FRONT(EmplaceHeavyBothEnds, Heavy);
+
+BENCHMARK_MAIN();
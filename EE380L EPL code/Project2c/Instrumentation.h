@@ -0,0 +1,69 @@
+// Instrumentation.h
+
+/* Opt-in allocation and copy counters for epl::vector (and so for
+ * epl::valarray, which is built on it).
+ *
+ * Compile with -DEPL_INSTRUMENT to turn the counters on. Without it every
+ * record_* function is an empty inline function and costs nothing.
+ * The counters are thread_local: each thread sees only what it did itself,
+ * so recording needs no locking. A test or a benchmark calls reset(), runs
+ * the code it wants to look at, then reads counters() or prints report().
+ */
+
+#ifndef _Instrumentation_h
+#define _Instrumentation_h
+
+#include <cstdint>
+#include <ostream>
+
+namespace epl {
+    struct instrumentation_counters {
+        uint64_t constructions{0};   //vectors created, including copies and moves
+        uint64_t copies{0};          //copy constructions and copy assignments
+        uint64_t moves{0};           //move constructions and move assignments
+        uint64_t reallocations{0};   //storage replaced to grow a vector
+        uint64_t bytes_allocated{0}; //total bytes of storage requested
+        uint64_t peak_capacity{0};   //largest single storage, in bytes
+    };
+
+    namespace instrumentation {
+        inline instrumentation_counters& counters(void) {
+            static thread_local instrumentation_counters c;
+            return c;
+        }
+
+        inline void reset(void) {
+            counters() = instrumentation_counters{};
+        }
+
+        inline void report(std::ostream& out) {
+            const instrumentation_counters& c = counters();
+            out << "constructions: " << c.constructions << std::endl;
+            out << "copies: " << c.copies << std::endl;
+            out << "moves: " << c.moves << std::endl;
+            out << "reallocations: " << c.reallocations << std::endl;
+            out << "bytes allocated: " << c.bytes_allocated << std::endl;
+            out << "peak capacity: " << c.peak_capacity << std::endl;
+        }
+
+#ifdef EPL_INSTRUMENT
+        inline void record_construction(void) { ++counters().constructions; }
+        inline void record_copy(void) { ++counters().copies; }
+        inline void record_move(void) { ++counters().moves; }
+        inline void record_reallocation(void) { ++counters().reallocations; }
+        inline void record_allocation(uint64_t bytes) {
+            instrumentation_counters& c = counters();
+            c.bytes_allocated += bytes;
+            if (bytes > c.peak_capacity) { c.peak_capacity = bytes; }
+        }
+#else
+        inline void record_construction(void) {}
+        inline void record_copy(void) {}
+        inline void record_move(void) {}
+        inline void record_reallocation(void) {}
+        inline void record_allocation(uint64_t) {}
+#endif
+    } //namespace instrumentation
+} //namespace epl
+
+#endif /* _Instrumentation_h */
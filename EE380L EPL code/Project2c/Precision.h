@@ -0,0 +1,115 @@
+// Precision.h
+
+/* Reduced precision storage types for epl::valarray.
+ *
+ * half (IEEE binary16) and bfloat16 only store values, they have no
+ * arithmetic of their own: every read converts to float, so a
+ * valarray<half> is computed in float and rounded back when stored.
+ * Conversions round to nearest even, as the hardware formats do.
+ */
+
+#ifndef _Precision_h
+#define _Precision_h
+
+#include <cstdint>
+#include <cstring>
+
+namespace epl {
+    struct half {
+        uint16_t bits;
+
+        half(void) : bits(0) {};
+        half(float f) : bits(from_float(f)) {};
+        operator float() const {
+            return to_float(bits);
+        }
+
+        static uint16_t from_float(float f) {
+            uint32_t x;
+            std::memcpy(&x, &f, sizeof(x));
+            uint32_t sign = (x >> 16) & 0x8000;
+            uint32_t mag = x & 0x7fffffff;
+            if (mag >= 0x7f800000) { //inf or nan
+                return (uint16_t)(sign | 0x7c00 | (mag > 0x7f800000 ? 0x200 : 0));
+            }
+            if (mag >= 0x477ff000) { //rounds past 65504
+                return (uint16_t)(sign | 0x7c00);
+            }
+            if (mag < 0x33000000) { //below half the smallest subnormal
+                return (uint16_t)sign;
+            }
+            uint32_t h;
+            uint32_t rem;
+            uint32_t halfway;
+            if (mag < 0x38800000) { //subnormal half, the unit is 2^-24
+                uint32_t shift = 126 - (mag >> 23);
+                uint32_t m = (mag & 0x7fffff) | 0x800000;
+                h = m >> shift;
+                rem = m & ((1u << shift) - 1);
+                halfway = 1u << (shift - 1);
+            } else { //rebias the exponent and drop 13 mantissa bits
+                h = (mag - 0x38000000) >> 13;
+                rem = mag & 0x1fff;
+                halfway = 0x1000;
+            }
+            if (rem > halfway || (rem == halfway && (h & 1))) {
+                ++h; //a carry into the exponent is still the right encoding
+            }
+            return (uint16_t)(sign | h);
+        }
+
+        static float to_float(uint16_t h) {
+            uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+            uint32_t exp = (h >> 10) & 0x1f;
+            uint32_t man = h & 0x3ff;
+            uint32_t x;
+            if (exp == 0x1f) {
+                x = sign | 0x7f800000 | (man << 13);
+            } else if (exp != 0) {
+                x = sign | ((exp + 112) << 23) | (man << 13);
+            } else if (man == 0) {
+                x = sign;
+            } else { //subnormal, normalize it
+                exp = 113;
+                while ((man & 0x400) == 0) {
+                    man <<= 1;
+                    --exp;
+                }
+                x = sign | (exp << 23) | ((man & 0x3ff) << 13);
+            }
+            float f;
+            std::memcpy(&f, &x, sizeof(f));
+            return f;
+        }
+    };
+
+    //the top half of a float: same range, 8 bits of mantissa
+    struct bfloat16 {
+        uint16_t bits;
+
+        bfloat16(void) : bits(0) {};
+        bfloat16(float f) : bits(from_float(f)) {};
+        operator float() const {
+            return to_float(bits);
+        }
+
+        static uint16_t from_float(float f) {
+            uint32_t x;
+            std::memcpy(&x, &f, sizeof(x));
+            if ((x & 0x7fffffff) > 0x7f800000) { //keep nan a (quiet) nan
+                return (uint16_t)((x >> 16) | 0x40);
+            }
+            x += 0x7fff + ((x >> 16) & 1);
+            return (uint16_t)(x >> 16);
+        }
+
+        static float to_float(uint16_t b) {
+            uint32_t x = (uint32_t)b << 16;
+            float f;
+            std::memcpy(&f, &x, sizeof(f));
+            return f;
+        }
+    };
+} //namespace epl
+
+#endif /* _Precision_h */
@@ -0,0 +1,273 @@
+// Storage.h
+
+/* Opt-in backing storage for large epl::vectors (and so for large
+ * epl::valarrays).
+ *
+ * By default every buffer comes from operator new. Setting
+ * policy().large_bytes makes buffers of at least that many bytes come
+ * straight from mmap, aligned to and advised for transparent huge pages, and
+ * placed on the NUMA nodes as policy().placement says:
+ *   interleave  - pages round robin over all nodes (mbind), for arrays that
+ *                 every thread reads all of
+ *   first_touch - the pages are touched by policy().threads threads, each
+ *                 taking one contiguous share, so every share lands on the
+ *                 node of the thread that touched it
+ * valarray splits large evaluations with parallel_for, which uses the same
+ * shares on threads pinned to the same CPUs, so with first_touch each thread
+ * computes on local memory.
+ *
+ * Set the policy before any large buffer exists; a buffer is always
+ * released the way it was allocated, even if the policy changed since.
+ * Off Linux the policy is ignored and everything comes from operator new.
+ */
+
+#ifndef _Storage_h
+#define _Storage_h
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace epl {
+    enum class numa_placement { none, interleave, first_touch };
+
+    struct storage_policy {
+        uint64_t large_bytes{0};                      //0 turns the policy off
+        numa_placement placement{numa_placement::none};
+        unsigned threads{0};                          //0 means one per hardware thread
+    };
+
+    namespace storage {
+        constexpr uint64_t huge_page = uint64_t(2) << 20;
+
+        inline storage_policy& policy(void) {
+            static storage_policy p;
+            return p;
+        }
+
+        inline unsigned threads(void) {
+            unsigned t = policy().threads;
+            if (t == 0) {
+                t = std::thread::hardware_concurrency();
+            }
+            return t == 0 ? 1 : t;
+        }
+
+        //true when a buffer of this size gets the large treatment (and parallel evaluation)
+        inline bool is_large(uint64_t bytes) {
+            return policy().large_bytes != 0 && bytes >= policy().large_bytes;
+        }
+
+#ifdef __linux__
+        //the CPUs this process may run on, in order
+        inline const std::vector<int>& allowed_cpus(void) {
+            static const std::vector<int> cpus = [] {
+                std::vector<int> c;
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+                    for (int k = 0; k < CPU_SETSIZE; ++k) {
+                        if (CPU_ISSET(k, &set)) {
+                            c.push_back(k);
+                        }
+                    }
+                }
+                return c;
+            }();
+            return cpus;
+        }
+
+        //keeps the calling thread on the CPU of share k of t, spread evenly over allowed_cpus()
+        inline void pin_share(uint64_t k, uint64_t t) {
+            const std::vector<int>& cpus = allowed_cpus();
+            if (cpus.size() < 2) {
+                return;
+            }
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpus[k * cpus.size() / t], &set);
+            pthread_setaffinity_np(pthread_self(), sizeof(set), &set); //advice only, fine if refused
+        }
+#else
+        inline void pin_share(uint64_t, uint64_t) {}
+#endif
+
+        /* run f(begin, end) over [0, n) split into threads() contiguous
+         * shares, each on its own thread pinned to the same CPU for every
+         * call with the same n, which is what first touch placement relies
+         * on. The caller only waits, so its own affinity is left alone. If
+         * a share throws, the first exception is rethrown here once every
+         * share has finished. */
+        template <typename F>
+        void parallel_for(uint64_t n, F f) {
+            uint64_t t = std::min<uint64_t>(threads(), n);
+            if (t <= 1) {
+                f(uint64_t(0), n);
+                return;
+            }
+            std::vector<std::exception_ptr> errors(t);
+            std::vector<std::thread> workers;
+            workers.reserve(t);
+            try {
+                for (uint64_t k = 0; k < t; ++k) {
+                    workers.emplace_back([&f, &errors, n, k, t] {
+                        try {
+                            pin_share(k, t);
+                            f(n * k / t, n * (k + 1) / t);
+                        } catch (...) {
+                            errors[k] = std::current_exception();
+                        }
+                    });
+                }
+            } catch (...) {
+                //could not start every thread: let the started ones finish first
+                for (auto& w : workers) {
+                    w.join();
+                }
+                throw;
+            }
+            for (auto& w : workers) {
+                w.join();
+            }
+            for (auto& e : errors) {
+                if (e) {
+                    std::rethrow_exception(e);
+                }
+            }
+        }
+
+#ifdef __linux__
+        //the buffers that came from mmap, and their mapped length
+        struct mapping_table {
+            std::mutex lock;
+            std::unordered_map<void*, uint64_t> lengths;
+            std::atomic<uint64_t> smallest{~uint64_t(0)}; //no lookup below this size
+        };
+
+        inline mapping_table& mappings(void) {
+            static mapping_table table;
+            return table;
+        }
+
+        //bit mask of the online nodes, from "0-1,3" style text
+        inline unsigned long online_nodes(void) {
+            std::ifstream in("/sys/devices/system/node/online");
+            unsigned long mask = 0;
+            unsigned first, last;
+            char sep;
+            while (in >> first) {
+                last = first;
+                if (in.peek() == '-') {
+                    in >> sep >> last;
+                }
+                for (unsigned n = first; n <= last && n < 8 * sizeof(mask); ++n) {
+                    mask |= 1ul << n;
+                }
+                if (in.peek() == ',') {
+                    in >> sep;
+                }
+            }
+            return mask == 0 ? 1 : mask;
+        }
+
+        inline void* map_large(uint64_t bytes) {
+            uint64_t length = (bytes + huge_page - 1) / huge_page * huge_page;
+            //map one huge page extra and trim, so the buffer starts on a huge page boundary
+            char* raw = (char*)mmap(nullptr, length + huge_page, PROT_READ | PROT_WRITE,
+                                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (raw == (char*)MAP_FAILED) {
+                throw std::bad_alloc();
+            }
+            char* p = (char*)(((uintptr_t)raw + huge_page - 1) / huge_page * huge_page);
+            if (p != raw) {
+                munmap(raw, p - raw);
+            }
+            if (p + length != raw + length + huge_page) {
+                munmap(p + length, raw + length + huge_page - (p + length));
+            }
+            madvise(p, length, MADV_HUGEPAGE); //advice only, fine if THP is off
+
+            if (policy().placement == numa_placement::interleave) {
+                const int mpol_interleave = 3; //MPOL_INTERLEAVE from <numaif.h>
+                unsigned long nodes = online_nodes();
+                syscall(SYS_mbind, p, length, mpol_interleave, &nodes, 8 * sizeof(nodes) + 1, 0);
+            } else if (policy().placement == numa_placement::first_touch) {
+                parallel_for(length / huge_page, [p](uint64_t b, uint64_t e) {
+                    for (uint64_t k = b; k < e; ++k) {
+                        p[k * huge_page] = 0;
+                    }
+                });
+            }
+
+            mapping_table& table = mappings();
+            std::lock_guard<std::mutex> guard(table.lock);
+            table.lengths[p] = length;
+            if (bytes < table.smallest.load()) {
+                table.smallest.store(bytes);
+            }
+            return p;
+        }
+
+        //unmaps p if it came from map_large
+        inline bool unmap_large(void* p, uint64_t bytes) {
+            mapping_table& table = mappings();
+            if (bytes < table.smallest.load(std::memory_order_relaxed)) {
+                return false;
+            }
+            uint64_t length;
+            {
+                std::lock_guard<std::mutex> guard(table.lock);
+                auto it = table.lengths.find(p);
+                if (it == table.lengths.end()) {
+                    return false;
+                }
+                length = it->second;
+                table.lengths.erase(it);
+            }
+            munmap(p, length);
+            return true;
+        }
+
+        //true if p is the start of a buffer that came from mmap
+        inline bool is_mapped(const void* p) {
+            mapping_table& table = mappings();
+            std::lock_guard<std::mutex> guard(table.lock);
+            return table.lengths.count(const_cast<void*>(p)) != 0;
+        }
+
+        inline void* allocate(uint64_t bytes) {
+            if (is_large(bytes)) {
+                return map_large(bytes);
+            }
+            return operator new(bytes);
+        }
+
+        inline void release(void* p, uint64_t bytes) {
+            if (p != nullptr && !unmap_large(p, bytes)) {
+                operator delete(p);
+            }
+        }
+#else
+        inline bool is_mapped(const void*) { return false; }
+        inline void* allocate(uint64_t bytes) { return operator new(bytes); }
+        inline void release(void* p, uint64_t) { operator delete(p); }
+#endif
+    } //namespace storage
+} //namespace epl
+
+#endif /* _Storage_h */
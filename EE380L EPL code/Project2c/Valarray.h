@@ -18,8 +18,10 @@
 #include <complex>
 #include <cmath>
 #include <functional>
+#include <memory>
 #include <type_traits>
 #include "Vector.h"
+#include "Precision.h"
 //using std::vector; // during development and testing
 using epl::vector; // after submission
 using namespace std::rel_ops;
@@ -43,6 +45,9 @@ namespace epl{
     template <> struct rank<int> { static constexpr int value = 1; };
     template <> struct rank<float> { static constexpr int value = 2; };
     template <> struct rank<double> { static constexpr int value = 3; };
+    //reduced precision storage computes in float
+    template <> struct rank<half> { static constexpr int value = 2; };
+    template <> struct rank<bfloat16> { static constexpr int value = 2; };
     template <typename T> struct rank<std::complex<T>> { static constexpr int value = rank<T>::value; };
     template <typename BASE> struct rank<vec_wrap<BASE>> { static constexpr int value = rank<typename BASE::value_type>::value; };
     
@@ -74,6 +79,21 @@ namespace epl{
         
         using type = typename ctype<my_comp, my_stype>::type;
     };
+
+    //precision of sqrt and the math functions: floating point data stays in
+    //its own precision (reduced storage in float), only int goes to double
+    template <typename T> struct compute_type { using type = T; };
+    template <> struct compute_type<int> { using type = double; };
+    template <> struct compute_type<half> { using type = float; };
+    template <> struct compute_type<bfloat16> { using type = float; };
+    template <typename T> struct compute_type<std::complex<T>> { using type = std::complex<typename compute_type<T>::type>; };
+
+    //reductions add in, and return, a wider type than they store
+    template <typename T> struct accumulate_type { using type = T; };
+    template <> struct accumulate_type<float> { using type = double; };
+    template <> struct accumulate_type<half> { using type = double; };
+    template <> struct accumulate_type<bfloat16> { using type = double; };
+    template <typename T> struct accumulate_type<std::complex<T>> { using type = std::complex<typename accumulate_type<T>::type>; };
     //if the content in vec_wrap is a vector, then we store a reference, if a proxy, then we store a value
     template <typename T>
     struct to_ref { using type = T; };
@@ -211,6 +231,77 @@ namespace epl{
             return (Result)std::sqrt(x);
         }
     };
+
+    /* the math functors below evaluate in the Result type (compute_type,
+     * so exp of a valarray<half> is computed in float), which keeps them
+     * within the libm bound for that type: 1 ulp for exp/log/sin/cos with
+     * glibc, a few ulp for pow and for the complex forms.
+     * Assigning one to contiguous storage from a contiguous operand runs a
+     * loop over raw pointers (vec_wrap::assign_elements), where -O3
+     * -ffast-math lets GCC call the glibc libmvec SIMD versions (_ZGV*,
+     * documented at 4 ulp). Everywhere else they are evaluated one checked
+     * element at a time.
+     */
+    template <typename Arg, typename Result>
+    struct exponential {
+        using argument_type = Arg;
+        using result_type = Result;
+        Result operator()(const Arg& x) const {
+            return std::exp((Result)x);
+        }
+    };
+
+    template <typename Arg, typename Result>
+    struct logarithm {
+        using argument_type = Arg;
+        using result_type = Result;
+        Result operator()(const Arg& x) const {
+            return std::log((Result)x);
+        }
+    };
+
+    template <typename Arg, typename Result>
+    struct sine {
+        using argument_type = Arg;
+        using result_type = Result;
+        Result operator()(const Arg& x) const {
+            return std::sin((Result)x);
+        }
+    };
+
+    template <typename Arg, typename Result>
+    struct cosine {
+        using argument_type = Arg;
+        using result_type = Result;
+        Result operator()(const Arg& x) const {
+            return std::cos((Result)x);
+        }
+    };
+
+    //x raised to a fixed exponent
+    template <typename Arg, typename Result>
+    struct power {
+        using argument_type = Arg;
+        using result_type = Result;
+        Result exponent;
+        power(Result _e) : exponent(_e) {};
+        Result operator()(const Arg& x) const {
+            return std::pow((Result)x, exponent);
+        }
+    };
+
+    //the magnitude of a complex number is real
+    template <typename T> struct real_type { using type = T; };
+    template <typename T> struct real_type<std::complex<T>> { using type = T; };
+
+    template <typename Arg, typename Result>
+    struct absolute {
+        using argument_type = Arg;
+        using result_type = Result;
+        Result operator()(const Arg& x) const {
+            return (Result)std::abs(x);
+        }
+    };
     
     template <typename T>
     struct scalar {
@@ -277,7 +368,7 @@ namespace epl{
         
         //constructor
         BinaryOperationProxy(BinaryOpertaion _op, const Left& _left, const Right& _right) : op(_op), left(_left), right(_right) {};
-        value_type operator[](uint16_t index) const {
+        value_type operator[](uint64_t index) const {
             auto leftvalue = (value_type)(this->left[index]);
             auto rightvalue = (value_type)(this->right[index]);
             
@@ -301,9 +392,246 @@ namespace epl{
         const_iterator end() const {
             return const_iterator(*this, this->size());
         }
-        
+
     };
-    
+
+    //slice view, length elements of a vector starting at start and stride apart
+    //the view refers to the elements, it never copies them
+    template <typename T>
+    struct SliceProxy {
+        using value_type = T;
+        using iterator = GeneralIterator<SliceProxy, value_type>;
+        using const_iterator = GeneralIterator<SliceProxy, value_type>;
+
+        //data members
+        vector<T>* base;
+        uint64_t start;
+        uint64_t length;
+        uint64_t stride;
+
+        //constructor
+        SliceProxy(vector<T>& _base, uint64_t _start, uint64_t _length, uint64_t _stride) : base(&_base), start(_start), length(_length), stride(_stride) {};
+        //copy constructor
+        SliceProxy(const SliceProxy& that) : base(that.base), start(that.start), length(that.length), stride(that.stride) {};
+        //assigning a view writes through to the elements instead of rebinding the view
+        SliceProxy& operator=(const SliceProxy& that) {
+            uint64_t n = std::min(this->size(), that.size());
+            std::vector<T> temp;
+            for (uint64_t i = 0; i < n; ++i) {
+                temp.push_back(that[i]);
+            }
+            for (uint64_t i = 0; i < n; ++i) {
+                (*this)[i] = temp[i];
+            }
+            return *this;
+        }
+
+        T& operator[](uint64_t index) const {
+            return (*base)[start + index * stride];
+        }
+        uint64_t size() const {
+            return length;
+        }
+
+        iterator begin() {
+            return iterator(*this, 0);
+        }
+        iterator end() {
+            return iterator(*this, this->size());
+        }
+        const_iterator begin() const {
+            return const_iterator(*this, 0);
+        }
+        const_iterator end() const {
+            return const_iterator(*this, this->size());
+        }
+    };
+
+    //indirect view, picks the elements of a vector at a list of positions
+    //a boolean mask is turned into the list of positions it selects
+    template <typename T>
+    struct IndirectProxy {
+        using value_type = T;
+        using iterator = GeneralIterator<IndirectProxy, value_type>;
+        using const_iterator = GeneralIterator<IndirectProxy, value_type>;
+
+        //data members, the positions are shared so copying the proxy stays cheap
+        vector<T>* base;
+        std::shared_ptr<const std::vector<uint64_t>> positions;
+
+        //constructor
+        IndirectProxy(vector<T>& _base, std::shared_ptr<const std::vector<uint64_t>> _positions) : base(&_base), positions(_positions) {};
+        //copy constructor
+        IndirectProxy(const IndirectProxy& that) : base(that.base), positions(that.positions) {};
+        //assigning a view writes through to the elements instead of rebinding the view
+        IndirectProxy& operator=(const IndirectProxy& that) {
+            uint64_t n = std::min(this->size(), that.size());
+            std::vector<T> temp;
+            for (uint64_t i = 0; i < n; ++i) {
+                temp.push_back(that[i]);
+            }
+            for (uint64_t i = 0; i < n; ++i) {
+                (*this)[i] = temp[i];
+            }
+            return *this;
+        }
+
+        T& operator[](uint64_t index) const {
+            return (*base)[(*positions)[index]];
+        }
+        uint64_t size() const {
+            return positions->size();
+        }
+
+        iterator begin() {
+            return iterator(*this, 0);
+        }
+        iterator end() {
+            return iterator(*this, this->size());
+        }
+        const_iterator begin() const {
+            return const_iterator(*this, 0);
+        }
+        const_iterator end() const {
+            return const_iterator(*this, this->size());
+        }
+    };
+
+    template <typename T> struct is_view : public std::false_type {};
+    template <typename T> struct is_view<SliceProxy<T>> : public std::true_type {};
+    template <typename T> struct is_view<IndirectProxy<T>> : public std::true_type {};
+
+    //does an expression read through a view somewhere
+    template <typename T> struct refers_to_view : public is_view<T> {};
+    template <typename BASE> struct refers_to_view<vec_wrap<BASE>> : public refers_to_view<BASE> {};
+    template <typename T1, typename UnaryOperation>
+    struct refers_to_view<UnaryOperationProxy<T1, UnaryOperation>> : public refers_to_view<T1> {};
+    template <typename BinaryOperation, typename Left, typename Right>
+    struct refers_to_view<BinaryOperationProxy<BinaryOperation, Left, Right>>
+    : public std::integral_constant<bool, refers_to_view<Left>::value || refers_to_view<Right>::value> {};
+
+    //recycles the buffers behind cached subexpressions, one pool per thread
+    template <typename T>
+    struct buffer_pool {
+        static constexpr uint64_t max_buffers = 8;
+
+        static std::vector<std::unique_ptr<std::vector<T>>>& free_buffers() {
+            static thread_local std::vector<std::unique_ptr<std::vector<T>>> buffers;
+            return buffers;
+        }
+        static std::shared_ptr<std::vector<T>> acquire(void) {
+            std::vector<std::unique_ptr<std::vector<T>>>& buffers = free_buffers();
+            std::vector<T>* buffer;
+            if (buffers.empty()) {
+                buffer = new std::vector<T>;
+            } else {
+                buffer = buffers.back().release();
+                buffers.pop_back();
+            }
+            return std::shared_ptr<std::vector<T>>(buffer, &buffer_pool::release);
+        }
+        static void release(std::vector<T>* buffer) {
+            std::vector<std::unique_ptr<std::vector<T>>>& buffers = free_buffers();
+            if (buffers.size() < max_buffers) {
+                buffer->clear(); //keeps the capacity for the next subexpression
+                buffers.emplace_back(buffer);
+            } else {
+                delete buffer;
+            }
+        }
+    };
+
+    //a subexpression evaluated once by cache(), later reads are plain loads
+    template <typename T>
+    struct CachedProxy {
+        using value_type = T;
+        using iterator = GeneralIterator<CachedProxy, value_type>;
+        using const_iterator = GeneralIterator<CachedProxy, value_type>;
+
+        //data members, copies of the proxy share the buffer
+        std::shared_ptr<std::vector<T>> values;
+
+        //constructor
+        CachedProxy(std::shared_ptr<std::vector<T>> _values) : values(_values) {};
+        //copy constructor
+        CachedProxy(const CachedProxy& that) : values(that.values) {};
+
+        const T& operator[](uint64_t index) const {
+            return (*values)[index];
+        }
+        uint64_t size() const {
+            return values->size();
+        }
+
+        iterator begin() {
+            return iterator(*this, 0);
+        }
+        iterator end() {
+            return iterator(*this, this->size());
+        }
+        const_iterator begin() const {
+            return const_iterator(*this, 0);
+        }
+        const_iterator end() const {
+            return const_iterator(*this, this->size());
+        }
+    };
+
+    /* compile time cost of an expression: nodes is the number of operations
+     * evaluated per element and loads the number of memory reads per element.
+     * e.g. static_assert(expr_cost<decltype(a * b + c)>::loads <= 3, "");
+     */
+    template <typename T> struct expr_cost;
+    template <typename T> struct expr_cost<vector<T>> {
+        static constexpr uint64_t nodes = 0;
+        static constexpr uint64_t loads = 1;
+    };
+    template <typename T> struct expr_cost<scalar<T>> {
+        static constexpr uint64_t nodes = 0;
+        static constexpr uint64_t loads = 0;
+    };
+    template <typename T> struct expr_cost<SliceProxy<T>> {
+        static constexpr uint64_t nodes = 0;
+        static constexpr uint64_t loads = 1;
+    };
+    template <typename T> struct expr_cost<IndirectProxy<T>> {
+        static constexpr uint64_t nodes = 0;
+        static constexpr uint64_t loads = 2; //the position, then the element
+    };
+    template <typename T> struct expr_cost<CachedProxy<T>> {
+        static constexpr uint64_t nodes = 0;
+        static constexpr uint64_t loads = 1;
+    };
+    template <typename BASE> struct expr_cost<vec_wrap<BASE>> : public expr_cost<BASE> {};
+    template <typename T1, typename UnaryOperation>
+    struct expr_cost<UnaryOperationProxy<T1, UnaryOperation>> {
+        static constexpr uint64_t nodes = 1 + expr_cost<T1>::nodes;
+        static constexpr uint64_t loads = expr_cost<T1>::loads;
+    };
+    template <typename BinaryOperation, typename Left, typename Right>
+    struct expr_cost<BinaryOperationProxy<BinaryOperation, Left, Right>> {
+        static constexpr uint64_t nodes = 1 + expr_cost<Left>::nodes + expr_cost<Right>::nodes;
+        static constexpr uint64_t loads = expr_cost<Left>::loads + expr_cost<Right>::loads;
+    };
+
+    //address of the first element when the elements are contiguous, nullptr otherwise
+    template <typename BASE>
+    const typename BASE::value_type* contiguous(const BASE& v) {
+        return nullptr;
+    }
+    template <typename T>
+    const T* contiguous(const vector<T>& v) {
+        return v.size() == 0 ? nullptr : &v[0];
+    }
+    template <typename T>
+    const T* contiguous(const SliceProxy<T>& v) {
+        return (v.stride != 1 || v.size() == 0) ? nullptr : &v[0];
+    }
+    template <typename T>
+    const T* contiguous(const CachedProxy<T>& v) {
+        return v.size() == 0 ? nullptr : &v[0];
+    }
+
     template <typename BASE>
     class vec_wrap : public BASE {
     public:
@@ -312,16 +640,13 @@ namespace epl{
         
         template <typename BASE2>
         vec_wrap& operator=(const vec_wrap<BASE2>& that) {
-            uint64_t size1 = this->size();
-            uint64_t size2 = that.size();
-            if (size1 > size2) {
-                for (int i = 0; i < size1 - size2; ++i) {
-                    this->pop_back();
-                }
-            }
-       
-            for (int i = 0; i < size1 && i < size2; ++i) {
-                (*this)[i] = (value_type)that[i];
+            if (refers_to_view<BASE2>::value || is_view<BASE>::value) {
+                //a view can read elements this assignment has already written, and
+                //one being assigned to can write elements the right hand side reads
+                vec_wrap<vector<typename BASE2::value_type>> temp(that);
+                assign_elements(temp);
+            } else {
+                assign_elements(that);
             }
             return *this;
         }
@@ -342,9 +667,11 @@ namespace epl{
         
         //assign a scalar to the valarray, maybe a problem
         vec_wrap& operator=(const value_type& val) {
-            for (int i = 0; i < this->size(); ++i) {
-                this->operator[](i) = val;
-            }
+            for_each_share(this->size(), [this, &val](uint64_t b, uint64_t e) {
+                for (uint64_t i = b; i < e; ++i) {
+                    this->operator[](i) = val;
+                }
+            });
             return *this;
         }
         
@@ -356,11 +683,49 @@ namespace epl{
         }
         
         // sqrt fuction object
-        template <typename T1 = typename choose_type<double, value_type>::type>
+        template <typename T1 = typename compute_type<value_type>::type>
         vec_wrap<UnaryOperationProxy<BASE, square_root<value_type, T1>>>
         sqrt() {
             return apply(square_root<value_type, T1>());
         }
+
+        //lazy math functions, computed in the same precision as sqrt
+        template <typename T1 = typename compute_type<value_type>::type>
+        vec_wrap<UnaryOperationProxy<BASE, exponential<value_type, T1>>>
+        exp() const {
+            return apply(exponential<value_type, T1>());
+        }
+
+        template <typename T1 = typename compute_type<value_type>::type>
+        vec_wrap<UnaryOperationProxy<BASE, logarithm<value_type, T1>>>
+        log() const {
+            return apply(logarithm<value_type, T1>());
+        }
+
+        template <typename T1 = typename compute_type<value_type>::type>
+        vec_wrap<UnaryOperationProxy<BASE, sine<value_type, T1>>>
+        sin() const {
+            return apply(sine<value_type, T1>());
+        }
+
+        template <typename T1 = typename compute_type<value_type>::type>
+        vec_wrap<UnaryOperationProxy<BASE, cosine<value_type, T1>>>
+        cos() const {
+            return apply(cosine<value_type, T1>());
+        }
+
+        template <typename T1 = typename compute_type<value_type>::type>
+        vec_wrap<UnaryOperationProxy<BASE, power<value_type, T1>>>
+        pow(typename std::common_type<T1>::type exponent) const {
+            return apply(power<value_type, T1>(exponent));
+        }
+
+        //abs keeps the element type, except complex elements become real
+        template <typename T1 = typename real_type<value_type>::type>
+        vec_wrap<UnaryOperationProxy<BASE, absolute<value_type, T1>>>
+        abs() const {
+            return apply(absolute<value_type, T1>());
+        }
         
         //accumulate function
         template <typename Acc>
@@ -377,9 +742,203 @@ namespace epl{
             }
         }
         
-        //sum function
-        value_type sum() {
-            return accumulate(std::plus<value_type>());
+        //sum function, in accumulate_type so a sum past what value_type holds still comes back
+        typename accumulate_type<value_type>::type sum() {
+            return accumulate(std::plus<typename accumulate_type<value_type>::type>());
+        }
+
+        //compound assignment, the right hand side can be a scalar or any expression
+        template <typename T, typename = WRAP<T>>
+        vec_wrap& operator+=(const T& that) {
+            return compound_assign<std::plus>(that);
+        }
+        template <typename T, typename = WRAP<T>>
+        vec_wrap& operator-=(const T& that) {
+            return compound_assign<std::minus>(that);
+        }
+        template <typename T, typename = WRAP<T>>
+        vec_wrap& operator*=(const T& that) {
+            return compound_assign<std::multiplies>(that);
+        }
+        template <typename T, typename = WRAP<T>>
+        vec_wrap& operator/=(const T& that) {
+            return compound_assign<std::divides>(that);
+        }
+
+        //evaluate this expression once into a pooled buffer, so a subexpression
+        //used several times, like s in s * s, is not recomputed for each use
+        vec_wrap<CachedProxy<value_type>> cache(void) const {
+            std::shared_ptr<std::vector<value_type>> values = buffer_pool<value_type>::acquire();
+            uint64_t n = static_cast<uint64_t>(this->size());
+            values->reserve(n);
+            for (uint64_t i = 0; i < n; ++i) {
+                values->push_back((*this)[i]);
+            }
+            return vec_wrap<CachedProxy<value_type>>(values);
+        }
+
+        //views, they can be read in expressions and assigned to
+        vec_wrap<SliceProxy<value_type>> slice(uint64_t start, uint64_t size, uint64_t stride = 1) {
+            return vec_wrap<SliceProxy<value_type>>(*this, start, size, stride);
+        }
+
+        template <typename Container>
+        vec_wrap<IndirectProxy<value_type>> indirect(const Container& index) {
+            std::shared_ptr<std::vector<uint64_t>> positions = std::make_shared<std::vector<uint64_t>>();
+            for (uint64_t i = 0; i < (uint64_t)index.size(); ++i) {
+                positions->push_back((uint64_t)index[i]);
+            }
+            return vec_wrap<IndirectProxy<value_type>>(*this, positions);
+        }
+
+        template <typename Container>
+        vec_wrap<IndirectProxy<value_type>> mask(const Container& m) {
+            std::shared_ptr<std::vector<uint64_t>> positions = std::make_shared<std::vector<uint64_t>>();
+            uint64_t n = std::min(static_cast<uint64_t>(this->size()), static_cast<uint64_t>(m.size()));
+            for (uint64_t i = 0; i < n; ++i) {
+                if (m[i]) {
+                    positions->push_back(i);
+                }
+            }
+            return vec_wrap<IndirectProxy<value_type>>(*this, positions);
+        }
+
+    private:
+        template <typename BASE2>
+        void assign_elements(const vec_wrap<BASE2>& that) {
+            uint64_t size1 = this->size();
+            uint64_t size2 = that.size();
+            if (size1 > size2) {
+                drop_back(size1 - size2, is_view<BASE>());
+            }
+
+            for_each_share(std::min(size1, size2), [this, &that](uint64_t b, uint64_t e) {
+                for (uint64_t i = b; i < e; ++i) {
+                    (*this)[i] = (value_type)that[i];
+                }
+            });
+        }
+
+        //a function of contiguous elements into contiguous elements: a loop over raw
+        //pointers the compiler can vectorize, instead of checked operator[] calls
+        template <typename T1, typename UnaryOperation>
+        void assign_elements(const vec_wrap<UnaryOperationProxy<T1, UnaryOperation>>& that) {
+            uint64_t size1 = this->size();
+            uint64_t size2 = that.size();
+            if (size1 > size2) {
+                drop_back(size1 - size2, is_view<BASE>());
+            }
+            uint64_t n = std::min(size1, size2);
+            value_type* dst = const_cast<value_type*>(contiguous(static_cast<const BASE&>(*this)));
+            const typename T1::value_type* src = contiguous(static_cast<const T1&>(that.val));
+            if (dst == nullptr || src == nullptr) {
+                for_each_share(n, [this, &that](uint64_t b, uint64_t e) {
+                    for (uint64_t i = b; i < e; ++i) {
+                        (*this)[i] = (value_type)that[i];
+                    }
+                });
+                return;
+            }
+            UnaryOperation op = that.op;
+            for_each_share(n, [dst, src, op](uint64_t b, uint64_t e) {
+                for (uint64_t i = b; i < e; ++i) {
+                    dst[i] = (value_type)op(src[i]);
+                }
+            });
+        }
+
+        /* element i of a result only depends on element i of its operands, so
+         * a large result is computed in storage::parallel_for shares: the
+         * same shares its storage was first touched in */
+        template <typename F>
+        void for_each_share(uint64_t n, F f) {
+            if (storage::is_large(n * sizeof(value_type))) {
+                storage::parallel_for(n, f);
+            } else {
+                f(uint64_t(0), n);
+            }
+        }
+
+        //a view has a fixed size, only a vector drops its extra elements
+        void drop_back(uint64_t n, std::false_type) {
+            for (uint64_t i = 0; i < n; ++i) {
+                this->pop_back();
+            }
+        }
+        void drop_back(uint64_t n, std::true_type) {}
+
+        //same promotion as x = x op y, but no proxy is built for the left hand side
+        template <template <typename> class Op, typename T>
+        vec_wrap& compound_assign(const T& that) {
+            const WRAP<T>& rhs = that;
+            in_place(rhs, Op<choose<vec_wrap, T>>(),
+                     std::integral_constant<bool, refers_to_view<WRAP<T>>::value || is_view<BASE>::value>());
+            return *this;
+        }
+
+        //a view, on either side, can read elements this pass has already written,
+        //so the right hand side is read into a temporary first
+        template <typename RHS, typename Op>
+        void in_place(const RHS& rhs, Op op, std::true_type) {
+            vec_wrap<vector<typename RHS::value_type>> temp(rhs);
+            in_place(temp, op);
+        }
+        //a scalar has nothing to overwrite
+        template <typename T, typename Op>
+        void in_place(const scalar<T>& rhs, Op op, std::true_type) {
+            in_place(rhs, op);
+        }
+        template <typename RHS, typename Op>
+        void in_place(const RHS& rhs, Op op, std::false_type) {
+            in_place(rhs, op);
+        }
+
+        //without views element i only reads element i of the right hand side,
+        //so a single forward pass is safe even when it refers to *this
+        template <typename RHS, typename Op>
+        void in_place(const RHS& rhs, Op op) {
+            using result_type = typename choose_type<value_type, typename RHS::value_type>::type;
+            uint64_t n = std::min(static_cast<uint64_t>(this->size()), static_cast<uint64_t>(rhs.size()));
+            for_each_share(n, [this, &rhs, op](uint64_t b, uint64_t e) {
+                for (uint64_t i = b; i < e; ++i) {
+                    (*this)[i] = (value_type)op((result_type)(*this)[i], (result_type)rhs[i]);
+                }
+            });
+        }
+
+        //both sides are contiguous with the same element type: walk the raw storage
+        //so the compiler can vectorize the loop (it adds its own overlap check)
+        template <typename BASE2, typename Op>
+        typename std::enable_if<std::is_same<typename BASE2::value_type, value_type>::value>::type
+        in_place(const vec_wrap<BASE2>& rhs, Op op) {
+            value_type* dst = const_cast<value_type*>(contiguous(static_cast<const BASE&>(*this)));
+            const value_type* src = contiguous(static_cast<const BASE2&>(rhs));
+            if (dst == nullptr || src == nullptr) {
+                in_place<vec_wrap<BASE2>, Op>(rhs, op);
+                return;
+            }
+            uint64_t n = std::min(static_cast<uint64_t>(this->size()), static_cast<uint64_t>(rhs.size()));
+            for_each_share(n, [dst, src, op](uint64_t b, uint64_t e) {
+                for (uint64_t i = b; i < e; ++i) {
+                    dst[i] = op(dst[i], src[i]);
+                }
+            });
+        }
+
+        template <typename Op>
+        void in_place(const scalar<value_type>& rhs, Op op) {
+            value_type* dst = const_cast<value_type*>(contiguous(static_cast<const BASE&>(*this)));
+            if (dst == nullptr) {
+                in_place<scalar<value_type>, Op>(rhs, op);
+                return;
+            }
+            uint64_t n = static_cast<uint64_t>(this->size());
+            const value_type val = rhs.val;
+            for_each_share(n, [dst, val, op](uint64_t b, uint64_t e) {
+                for (uint64_t i = b; i < e; ++i) {
+                    dst[i] = op(dst[i], val);
+                }
+            });
         }
     };
     
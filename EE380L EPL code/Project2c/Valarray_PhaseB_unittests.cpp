@@ -3,11 +3,15 @@
  * EPL - Spring 2015
  */
 
+#include <atomic>
 #include <chrono>
 #include <complex>
 #include <cstdint>
 #include <future>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <sstream>
 #include <stdexcept>
 
 #include "InstanceCounter.h"
@@ -90,3 +94,363 @@ TEST(PhaseB1, Lazy) {
     EXPECT_TRUE(match(ans[3], (v1[3] + v2[3] - (v3[3] * v4[3]))));
 }
 #endif
+
+#if defined(PHASE_B2_0) | defined(PHASE_B)
+TEST(PhaseB2, CompoundAssign) {
+    valarray<int> x{1, 2, 3, 4};
+    valarray<int> y{10, 20, 30, 40};
+
+    x += y;
+    EXPECT_EQ(44, x[3]);
+    x -= 1;
+    EXPECT_EQ(10, x[0]);
+    x *= x;
+    EXPECT_EQ(100, x[0]);
+    EXPECT_EQ(43 * 43, x[3]);
+    x /= 2 * y;
+    EXPECT_EQ(5, x[0]);
+
+    valarray<double> z{1.0, 2.0};
+    z += y + 0.5;
+    EXPECT_TRUE(match(z[0], 11.5));
+    EXPECT_TRUE(match(z[1], 22.5));
+
+    int cnt = InstanceCounter::counter;
+    z *= z + z;
+    EXPECT_EQ(cnt, InstanceCounter::counter);
+    EXPECT_TRUE(match(z[0], 2 * 11.5 * 11.5));
+}
+#endif
+
+#if defined(PHASE_B2_1) | defined(PHASE_B)
+TEST(PhaseB2, MathFunctions) {
+    valarray<double> x{0.25, 0.5, 1.0, 2.0};
+
+    valarray<double> y = x.exp().log();
+    valarray<double> one = x.sin() * x.sin() + x.cos() * x.cos();
+    valarray<double> cube = x.pow(3);
+    for (uint64_t i = 0; i < 4; ++i) {
+        EXPECT_TRUE(match(x[i], y[i]));
+        EXPECT_TRUE(match(1.0, one[i]));
+        EXPECT_TRUE(match(x[i] * x[i] * x[i], cube[i]));
+    }
+
+    valarray<int> n{-3, 4};
+    valarray<int> m = n.abs();
+    EXPECT_EQ(3, m[0]);
+    EXPECT_EQ(4, m[1]);
+
+    valarray<complex<float>> c(2);
+    c[0] = complex<float>(3.0, 4.0);
+    valarray<float> mag = c.abs();
+    EXPECT_EQ(5.0, mag[0]);
+    EXPECT_EQ(0.0, mag[1]);
+
+    valarray<complex<double>> e = c.exp();
+    EXPECT_TRUE(match(e[1].real(), 1.0));
+
+    // assignment takes the raw pointer loop: in place, and into a longer valarray
+    valarray<double> z = x;
+    z = z.exp();
+    valarray<double> w(6);
+    w = x.sqrt();
+    EXPECT_EQ(4, w.size());
+    for (uint64_t i = 0; i < 4; ++i) {
+        EXPECT_TRUE(match(std::exp(x[i]), z[i]));
+        EXPECT_TRUE(match(std::sqrt(x[i]), w[i]));
+    }
+}
+#endif
+
+#if defined(PHASE_B2_2) | defined(PHASE_B)
+TEST(PhaseB2, Views) {
+    valarray<int> x{0, 1, 2, 3, 4, 5, 6, 7};
+
+    // read a strided view through an expression
+    valarray<int> evens = x.slice(0, 4, 2) * 10;
+    EXPECT_EQ(4, evens.size());
+    EXPECT_EQ(60, evens[3]);
+
+    // write through the views
+    x.slice(1, 4, 2) = 0;
+    EXPECT_EQ(0, x[7]);
+    EXPECT_EQ(6, x[6]);
+    x.mask(std::vector<bool>{true, false, true}) += 100;
+    EXPECT_EQ(100, x[0]);
+    EXPECT_EQ(102, x[2]);
+    EXPECT_EQ(0, x[1]);
+    x.indirect(std::vector<int>{7, 5}) = x.slice(0, 2) + 1;
+    EXPECT_EQ(101, x[7]);
+    EXPECT_EQ(1, x[5]);
+
+    // overlapping source and target read the old values
+    valarray<int> y{1, 2, 3, 4, 5};
+    y.slice(1, 4) = y.slice(0, 4);
+    EXPECT_EQ(1, y[1]);
+    EXPECT_EQ(4, y[4]);
+    y.slice(1, 4) += y.slice(0, 4);
+    EXPECT_EQ(2, y[1]);
+    EXPECT_EQ(7, y[4]);
+    y = y.indirect(std::vector<int>{4, 3, 2, 1, 0});
+    EXPECT_EQ(7, y[0]);
+    EXPECT_EQ(1, y[4]);
+
+    // a view target over the valarray on the right reads the old values too
+    auto same = [](const valarray<int>& v, std::vector<int> want) {
+        bool equal = v.size() == want.size();
+        for (uint64_t i = 0; equal && i < want.size(); ++i) {
+            equal = v[i] == want[i];
+        }
+        return equal;
+    };
+    valarray<int> z{0, 1, 2, 3, 4};
+    z.slice(1, 4) = z;
+    EXPECT_TRUE(same(z, {0, 0, 1, 2, 3}));
+    z = valarray<int>{0, 1, 2, 3, 4};
+    z.slice(1, 4) += z;
+    EXPECT_TRUE(same(z, {0, 1, 3, 5, 7}));
+    z = valarray<int>{0, 1, 2, 3, 4};
+    z.indirect(std::vector<int>{4, 3, 2, 1, 0}) = z;
+    EXPECT_TRUE(same(z, {4, 3, 2, 1, 0}));
+    valarray<double> d{0.0, 1.0, 2.0};
+    d.slice(1, 2) = d.exp();
+    EXPECT_TRUE(match(1.0, d[1]));
+    EXPECT_TRUE(match(std::exp(1.0), d[2]));
+}
+#endif
+
+#if defined(PHASE_B2_3) | defined(PHASE_B)
+TEST(PhaseB2, Cache) {
+    valarray<double> a{1.0, 2.0, 3.0};
+    valarray<double> b{0.5, 0.5, 0.5};
+
+    using twice = decltype((a + b) * (a + b));
+    static_assert(expr_cost<twice>::nodes == 3, "a + b evaluated twice");
+    static_assert(expr_cost<twice>::loads == 4, "a and b loaded twice");
+
+    auto s = (a + b).cache();
+    using once = decltype(s * s);
+    static_assert(expr_cost<once>::nodes == 1, "only the product is left");
+    static_assert(expr_cost<once>::loads == 2, "one load per operand");
+    static_assert(expr_cost<decltype(a.indirect(std::vector<int>{0}) * 2)>::loads == 2, "position and element");
+
+    valarray<double> r = s * s;
+    EXPECT_EQ(3, r.size());
+    EXPECT_TRUE(match(r[2], 3.5 * 3.5));
+
+    // the cached values are a snapshot
+    a[0] = 100.0;
+    EXPECT_TRUE(match(s[0], 1.5));
+}
+#endif
+
+#if defined(PHASE_B2_4) | defined(PHASE_B)
+TEST(PhaseB2, Precision) {
+    EXPECT_EQ(0x3c00, half(1.0f).bits);
+    EXPECT_EQ(0x7bff, half(65504.0f).bits);
+    EXPECT_EQ(0x7c00, half(65520.0f).bits);
+    EXPECT_EQ(0x0001, half(5.96046448e-8f).bits);
+    EXPECT_EQ(5.96046448e-8f, (float)half(5.96046448e-8f));
+    EXPECT_EQ(0x3f80, bfloat16(1.0f).bits);
+    EXPECT_EQ(1.0f, (float)bfloat16(1.00390625f)); // tie rounds to even
+
+    valarray<half> h(4);
+    valarray<bfloat16> b(4);
+    h = 0.5f;
+    b = 0.25f;
+    static_assert(std::is_same<decltype(h + b)::value_type, float>::value, "computed in float");
+    static_assert(std::is_same<decltype(valarray<float>().sqrt())::value_type, float>::value, "float sqrt stays float");
+
+    valarray<half> r = (h + b) * 2;
+    EXPECT_EQ(1.5f, (float)r[3]);
+
+    // one million 0.1f, summed in double
+    valarray<float> f(1000000);
+    f = 0.1f;
+    EXPECT_NEAR(100000.0, f.sum(), 0.01);
+
+    // sums past the largest half (65504) and of values bfloat16 can't add 1 to
+    valarray<half> ones(100000);
+    ones = 1.0f;
+    static_assert(std::is_same<decltype(ones.sum()), double>::value, "half sums come back in double");
+    EXPECT_EQ(100000.0, ones.sum());
+    valarray<bfloat16> many(100000);
+    many = 1.0f;
+    EXPECT_EQ(100000.0, many.sum());
+}
+#endif
+
+#if defined(PHASE_B2_5) | defined(PHASE_B)
+namespace {
+    //its copy fails on demand
+    struct Fragile {
+        static int copies_left;
+        string value;
+        Fragile(const char* v) : value(v) {}
+        Fragile(const Fragile& that) : value(that.value) {
+            if (copies_left-- == 0) { throw std::runtime_error("copy failed"); }
+        }
+    };
+    int Fragile::copies_left = 0;
+}
+
+TEST(PhaseB2, VectorBulk) {
+    int a[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    epl::vector<int> v(a, a + 10);
+    EXPECT_EQ(10, v.size());
+
+    // insert near the back and near the front
+    int b[] = {-1, -2, -3};
+    v.insert(v.begin() + 8, b, b + 3);
+    v.insert(v.begin() + 1, {100, 200});
+    int expect[] = {1, 100, 200, 2, 3, 4, 5, 6, 7, 8, -1, -2, -3, 9, 10};
+    EXPECT_EQ(15, v.size());
+    for (int k = 0; k < 15; ++k) {
+        EXPECT_EQ(expect[k], v[k]);
+    }
+
+    v.erase(v.begin() + 1, v.begin() + 3);
+    v.erase(v.begin() + 8, v.begin() + 11);
+    for (int k = 0; k < 10; ++k) {
+        EXPECT_EQ(k + 1, v[k]);
+    }
+
+    // one allocation for the whole load
+    v.reserve(1000);
+    uint64_t reserved = v.capacity();
+    v.resize(1000, 7);
+    EXPECT_EQ(reserved, v.capacity());
+    EXPECT_EQ(7, v[999]);
+    v.resize(3);
+    EXPECT_EQ(3, v.size());
+    EXPECT_EQ(3, v.back());
+
+    // non trivial elements, and a single pass source
+    epl::vector<string> s;
+    std::istringstream in("b c d");
+    s.assign(std::istream_iterator<string>(in), std::istream_iterator<string>());
+    s.insert(s.begin(), 2, "a");
+    s.insert(s.end(), "e");
+    EXPECT_EQ(6, s.size());
+    EXPECT_EQ("a", s[1]);
+    EXPECT_EQ("e", s.back());
+    s.erase(s.begin());
+    EXPECT_EQ("a", s.front());
+    s.assign(4, "x");
+    EXPECT_EQ(4, s.size());
+    EXPECT_EQ("x", s[3]);
+
+    // a copy that throws leaves the target empty and usable, and leaks nothing
+    Fragile::copies_left = 100;
+    epl::vector<Fragile> f;
+    f.push_back("a");
+    f.push_back("b");
+    f.push_back("c");
+    Fragile::copies_left = 1;
+    EXPECT_THROW(epl::vector<Fragile> g(f), std::runtime_error);
+    epl::vector<Fragile> h;
+    h.push_back("z");
+    Fragile::copies_left = 1;
+    EXPECT_THROW(h = f, std::runtime_error);
+    EXPECT_EQ(0, h.size());
+    Fragile::copies_left = 100;
+    h.push_back("y");
+    EXPECT_EQ("y", h[0].value);
+    h = f;
+    EXPECT_EQ(3, h.size());
+    EXPECT_EQ("c", h.back().value);
+}
+#endif
+
+#if defined(PHASE_B2_6) | defined(PHASE_B)
+TEST(PhaseB2, VectorMoveOnly) {
+    epl::vector<std::unique_ptr<string>> v;
+    for (int k = 0; k < 20; ++k) {
+        v.emplace_back(new string(10, 'b'));
+        v.emplace_front(new string(10, 'f'));
+    }
+    EXPECT_EQ(40, v.size());
+    EXPECT_EQ('f', (*v.front())[0]);
+    EXPECT_EQ('b', (*v.back())[0]);
+
+    // several arguments, forwarded without copies
+    epl::vector<std::pair<std::unique_ptr<int>, string>> p;
+    p.emplace_back(std::unique_ptr<int>(new int(7)), "seven");
+    EXPECT_EQ(1, p.size());
+    EXPECT_EQ(7, *p[0].first);
+
+    epl::vector<std::unique_ptr<string>> w(std::move(v));
+    EXPECT_EQ(40, w.size());
+    EXPECT_EQ(0, v.size());
+}
+#endif
+
+#if defined(PHASE_B2_7) | defined(PHASE_B)
+TEST(PhaseB2, LargeStorage) {
+    storage_policy saved = storage::policy();
+    storage::policy().large_bytes = 1 << 20;
+    storage::policy().placement = numa_placement::first_touch;
+    storage::policy().threads = 4;
+    {
+        // 2^18 doubles: mapped, and past the old 16 bit index limit
+        const uint64_t n = 1 << 18;
+        valarray<double> a(n), b(n);
+        for (uint64_t i = 0; i < n; ++i) {
+            a[i] = (double)i;
+        }
+        b = 1.0;
+        valarray<double> c(n);
+        c = a + b * 2.0; // evaluated in four shares
+        c += a;
+        EXPECT_EQ(2.0, c[0]);
+        EXPECT_EQ(2.0 * 70000 + 2.0, c[70000]);
+        EXPECT_EQ(2.0 * (n - 1) + 2.0, c[n - 1]);
+#ifdef __linux__
+        EXPECT_TRUE(storage::is_mapped(&c[0]));
+#endif
+
+        // small arrays are not affected
+        valarray<double> small(100);
+        EXPECT_FALSE(storage::is_mapped(&small[0]));
+
+        // growing moves a mapped buffer to a bigger mapped buffer
+        c.push_back(1.0);
+        EXPECT_EQ(1.0, c[n]);
+    }
+
+    // a share that throws reaches the caller, after every share has run
+    std::atomic<int> shares{0};
+    EXPECT_THROW(storage::parallel_for(100, [&shares](uint64_t b, uint64_t e) {
+        ++shares;
+        if (b == 50) {
+            throw std::runtime_error("share failed");
+        }
+    }), std::runtime_error);
+    EXPECT_EQ(4, shares.load());
+    storage::policy() = saved;
+}
+#endif
+
+#if defined(EPL_INSTRUMENT)
+TEST(PhaseB2, Instrumentation) {
+    valarray<double> v1(100), v2(100);
+    instrumentation::reset();
+
+    valarray<double> ans(100);
+    ans = v1 + v2 * 2.0;
+    ans += v1.sqrt();
+    EXPECT_EQ(1, instrumentation::counters().constructions); // only ans itself
+    EXPECT_EQ(0, instrumentation::counters().copies);
+    EXPECT_EQ(100 * sizeof(double), instrumentation::counters().bytes_allocated);
+
+    for (int i = 0; i < 100; ++i) {
+        ans.push_back(1.0);
+    }
+    EXPECT_EQ(2, instrumentation::counters().reallocations); // half the new space goes to the front
+    EXPECT_EQ(400 * sizeof(double), instrumentation::counters().peak_capacity);
+
+    // other threads keep their own counters
+    std::async(std::launch::async, [] { valarray<int> x(10); }).wait();
+    EXPECT_EQ(1, instrumentation::counters().constructions);
+}
+#endif
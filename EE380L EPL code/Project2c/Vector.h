@@ -10,12 +10,17 @@
 #ifndef VECTOR_HPP_
 #define VECTOR_HPP_
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <iterator>
 #include <stdexcept>
+#include <type_traits>
 #include <utility>
 
 #include "InstanceCounter.h"
+#include "Instrumentation.h"
+#include "Storage.h"
 
 namespace epl {
 
@@ -43,17 +48,18 @@ public:
 	using value_type=T;
 	vector(void) {
 		uint64_t capacity = minimum_capacity;
-		sbegin = reinterpret_cast<T*>(operator new(capacity * sizeof(T)));
+		sbegin = allocate(capacity);
 		send = sbegin + capacity;
 		dbegin = dend = sbegin;
 
         InstanceCounter();
+        instrumentation::record_construction();
 	}
 
 	explicit vector(uint64_t sz) {
 		uint64_t capacity = sz;
 		if (sz == 0) { capacity = minimum_capacity; }
-		sbegin = reinterpret_cast<T*>(operator new(capacity * sizeof(T)));
+		sbegin = allocate(capacity);
 		send = sbegin + capacity;
 		dbegin = dend = sbegin;
 		for (uint64_t k = 0; k < sz; k += 1) {
@@ -62,28 +68,32 @@ public:
 		}
 
         InstanceCounter();
+        instrumentation::record_construction();
 	}
 
 	vector(const vector<T>& that) {
         std::cout << "epl::vector copy constructor" << std::endl;
         copy(that);
+        instrumentation::record_copy();
 
         InstanceCounter();
+        instrumentation::record_construction();
     }
 
 	template <typename AltType>
 	vector(const vector<AltType>& that) {
 		uint64_t capacity = that.size();
 		if (capacity == 0) { capacity = minimum_capacity; }
-		sbegin = reinterpret_cast<T*>(operator new(capacity * sizeof(T)));
+		sbegin = allocate(capacity);
 		send = sbegin + capacity;
 		dbegin = dend = sbegin;
-		for (uint64_t k = 0; k < capacity; k += 1) {
+		for (uint64_t k = 0; k < that.size(); k += 1) {
 			new (dend) T(that[k]);
 			++dend;
 		}
 
         InstanceCounter();
+        instrumentation::record_construction();
 	}
 
 	template <typename Iterator>
@@ -91,16 +101,19 @@ public:
 		constructFromIterator(b, e, typename std::iterator_traits<Iterator>::iterator_category());
 
         InstanceCounter();
+        instrumentation::record_construction();
 	}
 
     vector(std::initializer_list<T> il) : 
         vector(il.begin(), il.end()) {
 	}
 
-	vector(vector<T>&& that) {
+	vector(vector<T>&& that) noexcept {
         move(std::move(that)); 
+        instrumentation::record_move();
 
         InstanceCounter();
+        instrumentation::record_construction();
 	}
 	
     ~vector(void) { destroy(); }
@@ -109,6 +122,7 @@ public:
 		if (this != &that) {
 			destroy();
 			copy(that);
+			instrumentation::record_copy();
 		}
         return *this;
 	}
@@ -116,6 +130,7 @@ public:
 	vector<T>& operator=(vector<T>&& that) {
 		destroy();
 		move(std::move(that));
+		instrumentation::record_move();
 		return *this;
 	}
 
@@ -134,42 +149,43 @@ public:
 	}
 
 	void push_back(const T& that) {
-        T temp(that);
-		ensure_back_capacity(1);
-		new (dend) T(std::move(temp));
-		++dend;
+		emplace_back(that);
 	}
 
 	void push_back(T&& that) {
-    T temp(std::move(that));
-		ensure_back_capacity(1);
-		new (dend) T(std::move(temp));
-		++dend;
+		emplace_back(std::move(that));
 	}
 
 	template <typename... Args>
-	void emplace_back(Args... args) {
-		ensure_back_capacity(1);
-		new(dend) T(args...);
+	void emplace_back(Args&&... args) {
+		if (dend != send) {
+			new (dend) T(std::forward<Args>(args)...);
+		} else {
+			T temp(std::forward<Args>(args)...); // args may refer to an element of this vector
+			ensure_back_capacity(1);
+			new (dend) T(std::move(temp));
+		}
+		++dend;
 	}
 
 	void push_front(const T& that) {
-		ensure_front_capacity(1);
-		--dbegin;
-		new (dbegin) T(that);
+		emplace_front(that);
 	}
 
 	void push_front(T&& that) {
-		ensure_front_capacity(1);
-		--dbegin;
-		new (dbegin) T(std::move(that));
+		emplace_front(std::move(that));
 	}
 
 	template <typename... Args>
-	void emplace_front(Args... args) {
-		ensure_front_capacity(1);
+	void emplace_front(Args&&... args) {
+		if (dbegin != sbegin) {
+			new (dbegin - 1) T(std::forward<Args>(args)...);
+		} else {
+			T temp(std::forward<Args>(args)...);
+			ensure_front_capacity(1);
+			new (dbegin - 1) T(std::move(temp));
+		}
 		--dbegin;
-		new (dbegin) T(args...);
 	}
 
 	void pop_back(void) {
@@ -307,14 +323,139 @@ public:
 	const_iterator end(void) const { return const_iterator(this, dend); }
 	iterator end(void) { return iterator(this, dend); }
 
+	uint64_t capacity(void) const { return send - sbegin; }
+
+	/* make room for at least n elements in total, without reallocating again
+	 * until the vector grows past n */
+	void reserve(uint64_t n) {
+		if (n > size()) { ensure_back_capacity(n - size()); }
+	}
+
+	void clear(void) {
+		while (dbegin != dend) {
+			--dend;
+			dend->~T();
+		}
+	}
+
+	void resize(uint64_t n) {
+		if (n < size()) { truncate(n); return; }
+		ensure_back_capacity(n - size());
+		while (size() < n) {
+			new (dend) T();
+			++dend;
+		}
+	}
+
+	void resize(uint64_t n, const T& value) {
+		if (n < size()) { truncate(n); return; }
+		T temp(value); // value may be an element of this vector
+		ensure_back_capacity(n - size());
+		while (size() < n) {
+			new (dend) T(temp);
+			++dend;
+		}
+	}
+
+	template <typename Iterator>
+	void assign(Iterator b, Iterator e) {
+		assignFromIterator(b, e, typename std::iterator_traits<Iterator>::iterator_category());
+	}
+
+	void assign(std::initializer_list<T> il) {
+		assign(il.begin(), il.end());
+	}
+
+	void assign(uint64_t n, const T& value) {
+		T temp(value);
+		clear();
+		dbegin = dend = sbegin;
+		ensure_back_capacity(n);
+		for (uint64_t k = 0; k < n; k += 1) {
+			new (dend) T(temp);
+			++dend;
+		}
+	}
+
+	/* insert before pos. Whichever side of pos is shorter is moved to open
+	 * the gap, so inserting near the front is as cheap as near the back */
+	iterator insert(const_iterator pos, const T& value) {
+		T temp(value);
+		return insert(pos, std::move(temp));
+	}
+
+	iterator insert(const_iterator pos, T&& value) {
+		uint64_t index = pos.ptr - dbegin;
+		T* gap = open_gap(index, 1);
+		try {
+			new (gap) T(std::move(value));
+		} catch (...) {
+			close_gap(index, 1);
+			throw;
+		}
+		return iterator(this, gap);
+	}
+
+	iterator insert(const_iterator pos, uint64_t n, const T& value) {
+		T temp(value);
+		uint64_t index = pos.ptr - dbegin;
+		T* gap = open_gap(index, n);
+		T* p = gap;
+		try {
+			for (; p != gap + n; ++p) { new (p) T(temp); }
+		} catch (...) {
+			while (p != gap) { --p; p->~T(); }
+			close_gap(index, n);
+			throw;
+		}
+		return iterator(this, gap);
+	}
+
+	template <typename Iterator>
+	iterator insert(const_iterator pos, Iterator b, Iterator e) {
+		uint64_t index = pos.ptr - dbegin;
+		insertFromIterator(index, b, e, typename std::iterator_traits<Iterator>::iterator_category());
+		return iterator(this, dbegin + index);
+	}
+
+	iterator insert(const_iterator pos, std::initializer_list<T> il) {
+		return insert(pos, il.begin(), il.end());
+	}
+
+	iterator erase(const_iterator pos) {
+		uint64_t index = pos.ptr - dbegin;
+		dbegin[index].~T();
+		close_gap(index, 1);
+		return iterator(this, dbegin + index);
+	}
+
+	iterator erase(const_iterator first, const_iterator last) {
+		uint64_t index = first.ptr - dbegin;
+		uint64_t n = last.ptr - first.ptr;
+		for (T* p = dbegin + index; p != dbegin + index + n; ++p) {
+			p->~T();
+		}
+		close_gap(index, n);
+		return iterator(this, dbegin + index);
+	}
+
 private:
+	static T* allocate(uint64_t capacity) {
+		instrumentation::record_allocation(capacity * sizeof(T));
+		return reinterpret_cast<T*>(storage::allocate(capacity * sizeof(T)));
+	}
+
+	static void deallocate(T* p, uint64_t capacity) {
+		storage::release(p, capacity * sizeof(T));
+	}
+
 	void destroy(void) {
 		if (sbegin != nullptr) {
 			while (dbegin != dend) {
 				dbegin->~T();
 				++dbegin;
 			}
-			operator delete(sbegin);
+			deallocate(sbegin, send - sbegin);
 		}
 	}
 
@@ -328,12 +469,22 @@ private:
 		 */
 		uint64_t capacity = that.size();
 		if (capacity < minimum_capacity) { capacity = minimum_capacity; }
-		sbegin = reinterpret_cast<T*>(operator new(capacity * sizeof(T)));
-		dbegin = dend = sbegin;
-		for (uint64_t k = 0; k < that.size(); k += 1) {
-			new (dend) T(that[k]);
-			++dend;
+		/* built in a block of its own, so if a copy throws this is left
+		 * empty (operator= has already destroyed the old elements) and the
+		 * block is freed */
+		T* block = allocate(capacity);
+		T* end;
+		try {
+			end = construct_range(block, that.begin(), that.size());
+		} catch (...) {
+			deallocate(block, capacity);
+			sbegin = send = dbegin = dend = nullptr;
+			throw;
 		}
+		sbegin = block;
+		send = block + capacity;
+		dbegin = block;
+		dend = end;
 	}
 
 	void move(vector<T>&& that) {
@@ -346,28 +497,217 @@ private:
 
 	template <typename Iterator>
 	void constructFromIterator(Iterator b, Iterator e, std::random_access_iterator_tag) {
-		uint64_t capacity = (uint64_t) (e - b);
-		if (capacity < minimum_capacity) { capacity = minimum_capacity; }
-		sbegin = reinterpret_cast<T*>(operator new(capacity * sizeof(T)));
+		constructSized(b, (uint64_t) (e - b));
+	}
+
+	template <typename Iterator>
+	void constructFromIterator(Iterator b, Iterator e, std::forward_iterator_tag) {
+		constructSized(b, (uint64_t) std::distance(b, e));
+	}
+
+	/* a single pass iterator can only be read once, so its length is not
+	 * known up front */
+	template <typename Iterator>
+	void constructFromIterator(Iterator b, Iterator e, std::input_iterator_tag) {
+		uint64_t capacity = minimum_capacity;
+		sbegin = allocate(capacity);
+		send = sbegin + capacity;
 		dbegin = dend = sbegin;
 		while (b != e) {
-			new (dend) T(*b);
-			++dend;
+			push_back(*b);
 			++b;
 		}
 	}
 
 	template <typename Iterator>
-	void constructFromIterator(Iterator b, Iterator e, std::forward_iterator_tag) {
-		uint64_t capacity = minimum_capacity;
-		sbegin = reinterpret_cast<T*>(operator new(capacity * sizeof(T)));
+	void constructSized(Iterator b, uint64_t n) {
+		uint64_t capacity = n;
+		if (capacity < minimum_capacity) { capacity = minimum_capacity; }
+		sbegin = allocate(capacity);
+		send = sbegin + capacity;
+		dbegin = sbegin;
+		try {
+			dend = construct_range(sbegin, b, n);
+		} catch (...) {
+			deallocate(sbegin, capacity);
+			throw;
+		}
+	}
+
+	template <typename Iterator>
+	void assignFromIterator(Iterator b, Iterator e, std::forward_iterator_tag) {
+		uint64_t n = std::distance(b, e);
+		clear();
 		dbegin = dend = sbegin;
+		ensure_back_capacity(n);
+		dend = construct_range(dend, b, n);
+	}
+
+	template <typename Iterator>
+	void assignFromIterator(Iterator b, Iterator e, std::input_iterator_tag) {
+		clear();
 		while (b != e) {
 			push_back(*b);
 			++b;
 		}
 	}
 
+	template <typename Iterator>
+	void insertFromIterator(uint64_t index, Iterator b, Iterator e, std::forward_iterator_tag) {
+		uint64_t n = std::distance(b, e);
+		T* gap = open_gap(index, n);
+		try {
+			construct_range(gap, b, n);
+		} catch (...) {
+			close_gap(index, n);
+			throw;
+		}
+	}
+
+	//append the elements, then rotate them into place
+	template <typename Iterator>
+	void insertFromIterator(uint64_t index, Iterator b, Iterator e, std::input_iterator_tag) {
+		uint64_t old_size = size();
+		while (b != e) {
+			push_back(*b);
+			++b;
+		}
+		std::rotate(dbegin + index, dbegin + old_size, dend);
+	}
+
+	/* memcpy is only used when the source is a plain array of T (or one of
+	 * our own iterators, which wrap a T*) and T is trivially copyable */
+	template <typename Iterator>
+	static Iterator raw(Iterator i) { return i; }
+	static const T* raw(const_iterator i) { return i.ptr; }
+	static const T* raw(iterator i) { return i.ptr; }
+
+	template <typename Iterator>
+	using bitwise_copyable = std::integral_constant<bool,
+		std::is_trivially_copyable<T>::value
+		&& (std::is_same<Iterator, T*>::value || std::is_same<Iterator, const T*>::value)>;
+
+	/* copy construct n elements from b into the raw storage at dest and
+	 * return the end of the new elements. If a copy throws, the elements
+	 * already made are destroyed again */
+	template <typename Iterator>
+	static T* construct_range(T* dest, Iterator b, uint64_t n) {
+		return construct_range(dest, raw(b), n, bitwise_copyable<decltype(raw(b))>());
+	}
+
+	template <typename Iterator>
+	static T* construct_range(T* dest, Iterator b, uint64_t n, std::true_type) {
+		if (n > 0) { std::memcpy(dest, b, n * sizeof(T)); }
+		return dest + n;
+	}
+
+	template <typename Iterator>
+	static T* construct_range(T* dest, Iterator b, uint64_t n, std::false_type) {
+		T* p = dest;
+		try {
+			for (; n > 0; --n, ++b, ++p) {
+				new (p) T(*b);
+			}
+		} catch (...) {
+			while (p != dest) { --p; p->~T(); }
+			throw;
+		}
+		return p;
+	}
+
+	/* move the elements [first, last) to dest, which may overlap them; the
+	 * originals are destroyed */
+	static void relocate(T* first, T* last, T* dest) {
+		relocate(first, last, dest, std::is_trivially_copyable<T>());
+	}
+
+	static void relocate(T* first, T* last, T* dest, std::true_type) {
+		if (first != last) { std::memmove(dest, first, (last - first) * sizeof(T)); }
+	}
+
+	static void relocate(T* first, T* last, T* dest, std::false_type) {
+		if (dest < first) {
+			for (; first != last; ++first, ++dest) {
+				new (dest) T(std::move(*first));
+				first->~T();
+			}
+		} else {
+			dest += last - first;
+			while (last != first) {
+				--last;
+				--dest;
+				new (dest) T(std::move(*last));
+				last->~T();
+			}
+		}
+	}
+
+	/* open n slots of raw storage in front of element index and return the
+	 * first of them. The shorter side of index is the one that moves */
+	T* open_gap(uint64_t index, uint64_t n) {
+		if (n == 0) { return dbegin + index; }
+		if (index < size() - index) {
+			ensure_front_capacity(n);
+			relocate(dbegin, dbegin + index, dbegin - n);
+			dbegin -= n;
+		} else {
+			ensure_back_capacity(n);
+			relocate(dbegin + index, dend, dbegin + index + n);
+			dend += n;
+		}
+		return dbegin + index;
+	}
+
+	//undo open_gap: the n slots at index hold no elements
+	void close_gap(uint64_t index, uint64_t n) {
+		if (n == 0) { return; }
+		if (index < size() - index - n) {
+			relocate(dbegin, dbegin + index, dbegin + n);
+			dbegin += n;
+		} else {
+			relocate(dbegin + index + n, dend, dbegin + index);
+			dend -= n;
+		}
+	}
+
+	void truncate(uint64_t n) {
+		while (size() > n) {
+			--dend;
+			dend->~T();
+		}
+	}
+
+	/* bring the elements over to new_data in new_storage and make that the
+	 * storage. Elements are moved only when their move constructor cannot
+	 * throw, otherwise they are copied, so if a copy throws the new storage
+	 * is released and the vector is unchanged (move only types are moved
+	 * regardless) */
+	void transfer(T* new_storage, T* new_data, uint64_t capacity) {
+		T* new_data_end = new_data;
+		try {
+			for (T* p = dbegin; p != dend; ++p, ++new_data_end) {
+				new (new_data_end) T(std::move_if_noexcept(*p));
+			}
+		} catch (...) {
+			while (new_data_end != new_data) {
+				--new_data_end;
+				new_data_end->~T();
+			}
+			deallocate(new_storage, capacity);
+			throw;
+		}
+		while (dbegin != dend) {
+			dbegin->~T();
+			++dbegin;
+		}
+		deallocate(sbegin, send - sbegin);
+
+		sbegin = new_storage;
+		send = sbegin + capacity;
+		dbegin = new_data;
+		dend = new_data_end;
+	}
+
 	void ensure_back_capacity(uint64_t back_capacity) {
 		if (back_capacity <= (uint64_t) (send - dend)) { // sufficient capacity
 			return;
@@ -375,8 +715,9 @@ private:
 
 		/* try doubling capacity */
 		uint64_t capacity = 2 * (send - sbegin);
+		if (capacity < minimum_capacity) { capacity = minimum_capacity; }
 
-		while (capacity < back_capacity) {
+		while (capacity < size() + back_capacity) {
 			capacity *= 2;
 		}
 
@@ -386,23 +727,11 @@ private:
 		uint64_t excess_capacity = capacity - size();
 		if (back_capacity < excess_capacity / 2) { back_capacity = excess_capacity / 2; }
 
-		T* new_storage = reinterpret_cast<T*>(operator new(sizeof(T) * capacity));
+		T* new_storage = allocate(capacity);
+		instrumentation::record_reallocation();
 		T* new_data = new_storage + capacity - back_capacity - size();
-		T* new_data_end = new_data;
 
-		/* move the elements (and deconstruct the originals) */
-		while (dbegin != dend) {
-			new (new_data_end) T(std::move(*dbegin));
-			dbegin->~T();
-			++dbegin;
-			++new_data_end;
-		}
-		operator delete(sbegin);
-
-		sbegin = new_storage;
-		send = sbegin + capacity;
-		dbegin = new_data;
-		dend = new_data_end;
+		transfer(new_storage, new_data, capacity);
 	}
 
 	void ensure_front_capacity(uint64_t front_capacity) {
@@ -412,8 +741,9 @@ private:
 
 		/* try doubling capacity */
 		uint64_t capacity = 2 * (send - sbegin);
+		if (capacity < minimum_capacity) { capacity = minimum_capacity; }
 
-		while (capacity < front_capacity) {
+		while (capacity < size() + front_capacity) {
 			capacity *= 2;
 		}
 
@@ -423,23 +753,11 @@ private:
 		uint64_t excess_capacity = capacity - size();
 		if (front_capacity < excess_capacity / 2) { front_capacity = excess_capacity / 2; }
 
-		T* new_storage = reinterpret_cast<T*>(operator new(sizeof(T) * capacity));
+		T* new_storage = allocate(capacity);
+		instrumentation::record_reallocation();
 		T* new_data = new_storage + front_capacity;
-		T* new_data_end = new_data;
-
-		/* move the elements (and deconstruct the originals) */
-		while (dbegin != dend) {
-			new (new_data_end) T(std::move(*dbegin));
-			dbegin->~T();
-			++dbegin;
-			++new_data_end;
-		}
-		operator delete(sbegin);
 
-		sbegin = new_storage;
-		send = sbegin + capacity;
-		dbegin = new_data;
-		dend = new_data_end;
+		transfer(new_storage, new_data, capacity);
 	}
 
 };
@@ -0,0 +1,80 @@
+/*
+ * Valarray_benchmarks.cpp
+ *
+ * Google Benchmark cases for the lazy math functions of epl::valarray. Each
+ * function is evaluated two ways over the same data:
+ *   Checked - one element at a time through the expression's operator[],
+ *             which is how every other expression is evaluated
+ *   Assign  - y = x.exp() and so on, which walks the raw storage and (with
+ *             the Makefile's -O3 -ffast-math) calls the libmvec SIMD versions
+ */
+
+#include <cstdint>
+#include <iostream>
+
+#include "benchmark/benchmark.h"
+#include "Valarray.h"
+
+int InstanceCounter::counter = 0; //Vector.h counts its instances, the tests define this too
+
+namespace {
+    struct Exp { template <typename V> static auto of(const V& x) -> decltype(x.exp()) { return x.exp(); } };
+    struct Log { template <typename V> static auto of(const V& x) -> decltype(x.log()) { return x.log(); } };
+    struct Sin { template <typename V> static auto of(const V& x) -> decltype(x.sin()) { return x.sin(); } };
+    struct Cos { template <typename V> static auto of(const V& x) -> decltype(x.cos()) { return x.cos(); } };
+    struct Pow { template <typename V> static auto of(const V& x) -> decltype(x.pow(1.5)) { return x.pow(1.5); } };
+
+    //positive and small enough for every function above
+    template <typename T>
+    epl::valarray<T> filled(uint64_t n) {
+        epl::valarray<T> x(n);
+        for (uint64_t i = 0; i < n; ++i) {
+            x[i] = (T)(0.5 + (double)(i % 1000) / 250);
+        }
+        return x;
+    }
+
+    constexpr int64_t min_size = 1 << 10;
+    constexpr int64_t max_size = 1 << 20;
+} //namespace
+
+template <typename F, typename T>
+void Checked(benchmark::State& state) {
+    const uint64_t n = state.range(0);
+    epl::valarray<T> x = filled<T>(n);
+    epl::valarray<T> y(n);
+    for (auto _ : state) {
+        auto e = F::of(x);
+        for (uint64_t i = 0; i < n; ++i) {
+            y[i] = (T)e[i];
+        }
+        benchmark::DoNotOptimize(y[n - 1]);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename F, typename T>
+void Assign(benchmark::State& state) {
+    const uint64_t n = state.range(0);
+    epl::valarray<T> x = filled<T>(n);
+    epl::valarray<T> y(n);
+    for (auto _ : state) {
+        y = F::of(x);
+        benchmark::DoNotOptimize(y[n - 1]);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+#define EPL_BENCHMARK_MATH(F, T) \
+    BENCHMARK_TEMPLATE(Checked, F, T)->RangeMultiplier(32)->Range(min_size, max_size); \
+    BENCHMARK_TEMPLATE(Assign, F, T)->RangeMultiplier(32)->Range(min_size, max_size)
+
+EPL_BENCHMARK_MATH(Exp, double);
+EPL_BENCHMARK_MATH(Log, double);
+EPL_BENCHMARK_MATH(Sin, double);
+EPL_BENCHMARK_MATH(Cos, double);
+EPL_BENCHMARK_MATH(Pow, double);
+EPL_BENCHMARK_MATH(Exp, float);
+EPL_BENCHMARK_MATH(Sin, float);
+
+BENCHMARK_MAIN();
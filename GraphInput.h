@@ -0,0 +1,196 @@
+//
+//  GraphInput.h
+//  algorithm_proj3
+//
+//  Reading the input files EE360CProject3 and MinimizeTotalTardiness share:
+//  the number of processes, then one "id time {dep,dep:cost,...}" record per
+//  process. EE360CProject3 --stream reads its records with ReadRecord too.
+//  Each tool has its own Graph, with at least process_vec, whose Processes
+//  have processID, execution_time, depend_offset and depend_count, and
+//  adjacency, the arena the dependency IDs go in.
+//
+//  The records must be 1 to n in order, n being the count, and every
+//  dependency one of 1 to n, since both tools index process_vec by ID - 1.
+//  Execution times and costs can't be negative. A file that breaks any of
+//  that, or has anything else in it, is malformed.
+//
+
+#ifndef _GraphInput_h
+#define _GraphInput_h
+
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <sys/stat.h>
+
+enum class LoadStatus { ok, unreadable, malformed };
+
+inline void SkipBlanks(const char*& c, const char* end) {
+    while (c < end && isspace((unsigned char)*c)) {
+        ++c;
+    }
+}
+
+//skips blanks and reads an int; false, with c unmoved past the blanks, if there isn't one or it overflows
+inline bool ReadInt(const char*& c, const char* end, int& value) {
+    SkipBlanks(c, end);
+    bool negative = c < end && *c == '-';
+    const char* digits = negative ? c + 1 : c;
+    if (digits == end || !isdigit((unsigned char)*digits)) {
+        return false;
+    }
+    value = 0;
+    const char* d = digits;
+    for (; d < end && isdigit((unsigned char)*d); ++d) {
+        if (value > (INT_MAX - (*d - '0')) / 10) {
+            return false;
+        }
+        value = value * 10 + (*d - '0');
+    }
+    c = d;
+    if (negative) {
+        value = -value;
+    }
+    return true;
+}
+
+//skips blanks and then one punctuation character; false, with c unmoved past the blanks, if it isn't there
+inline bool ReadChar(const char*& c, const char* end, char expected) {
+    SkipBlanks(c, end);
+    if (c == end || *c != expected) {
+        return false;
+    }
+    ++c;
+    return true;
+}
+
+/*
+ * Reads one "id time {dep,dep:cost,...}" record. The dependencies are
+ * appended to depend and, if cost isn't null, their transfer costs to cost,
+ * 0 where none is given. False if the record is malformed, which includes a
+ * negative execution time or cost; which IDs are valid is up to the caller.
+ */
+inline bool ReadRecord(const char*& c, const char* end, int& id, int& execution_time,
+                       std::vector<int>& depend, std::vector<int>* cost) {
+    if (!ReadInt(c, end, id) || !ReadInt(c, end, execution_time) || execution_time < 0
+        || !ReadChar(c, end, '{')) {
+        return false;
+    }
+    if (ReadChar(c, end, '}')) {
+        return true;
+    }
+    do {
+        int number, transfer = 0;
+        if (!ReadInt(c, end, number)
+            || (ReadChar(c, end, ':') && (!ReadInt(c, end, transfer) || transfer < 0))) {
+            return false;
+        }
+        depend.push_back(number);
+        if (cost != nullptr) {
+            cost->push_back(transfer);
+        }
+    } while (ReadChar(c, end, ','));
+    return ReadChar(c, end, '}');
+}
+
+/*
+ * Reads a whole input file into g: the count line, then the records. Only
+ * the IDs, execution times and dependency runs of g.process_vec and the
+ * dependencies in g.adjacency are filled in, and each dependency's transfer
+ * cost goes in cost if it isn't null, 0 where none is given; everything
+ * else about g is up to the caller, who mustn't use g unless the status is
+ * ok. text holds the file, and the Processes are refilled in place, so
+ * reading one file after another into the same text and Graph allocates
+ * only when a file is bigger than any before it.
+ */
+template <typename Graph>
+LoadStatus LoadGraph(const std::string& file, std::string& text, Graph& g, std::vector<int>* cost = nullptr) {
+    FILE* in = fopen(file.c_str(), "rb");
+    if (in == nullptr) {
+        return LoadStatus::unreadable;
+    }
+    text.clear();
+    char chunk[1 << 16];
+    size_t got;
+    while ((got = fread(chunk, 1, sizeof(chunk), in)) > 0) {
+        text.append(chunk, got);
+    }
+    fclose(in);
+
+    g.adjacency.clear();
+    if (cost != nullptr) {
+        cost->clear();
+    }
+    size_t n = 0;
+    const char* c = text.data();
+    const char* end = c + text.size();
+    int count, number, execution_time;
+    auto malformed = [&g, &n](void) {
+        g.process_vec.resize(n);
+        return LoadStatus::malformed;
+    };
+    if (!ReadInt(c, end, count) || count < 0) {
+        return malformed();
+    }
+    for (SkipBlanks(c, end); c != end; SkipBlanks(c, end)) {
+        if (n == g.process_vec.size()) {
+            g.process_vec.emplace_back();
+        }
+        auto& p = g.process_vec[n++];
+        p.depend_offset = (int)g.adjacency.size();
+        if (!ReadRecord(c, end, number, execution_time, g.adjacency, cost) || number != (int)n) {
+            return malformed();
+        }
+        p.processID = number;
+        p.execution_time = execution_time;
+        p.depend_count = (int)g.adjacency.size() - p.depend_offset;
+    }
+    if ((int)n != count) {
+        return malformed();
+    }
+    for (auto id : g.adjacency) {
+        if (id < 1 || id > count) {
+            return malformed();
+        }
+    }
+    g.process_vec.resize(n);
+    return LoadStatus::ok;
+}
+
+//the files in a directory, by name, or the paths listed one per line in a manifest
+inline std::vector<std::string> BatchFiles(const std::string& path) {
+    std::vector<std::string> files;
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) {
+        return files;
+    }
+    if (S_ISDIR(info.st_mode)) {
+        DIR* dir = opendir(path.c_str());
+        while (dirent* entry = dir ? readdir(dir) : nullptr) {
+            std::string file = path + "/" + entry->d_name;
+            if (stat(file.c_str(), &info) == 0 && S_ISREG(info.st_mode)) {
+                files.push_back(file);
+            }
+        }
+        if (dir) {
+            closedir(dir);
+        }
+        std::sort(files.begin(), files.end());
+    } else {
+        std::ifstream manifest(path);
+        std::string line;
+        while (getline(manifest, line)) {
+            if (!line.empty()) {
+                files.push_back(line);
+            }
+        }
+    }
+    return files;
+}
+
+#endif
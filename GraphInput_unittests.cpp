@@ -0,0 +1,95 @@
+/*
+ * GraphInput_unittests.cpp
+ *
+ * Tests for GraphInput.h, the input reader of EE360CProject3 (whole files
+ * and --stream) and MinimizeTotalTardiness.
+ * g++ -std=c++11 GraphInput_unittests.cpp -lgtest -lgtest_main -pthread
+ */
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "GraphInput.h"
+
+namespace {
+    //what --stream hands ReadRecord: one line, which must hold one record and nothing else
+    bool ReadLine(const std::string& line, int& id, int& time, std::vector<int>& depend, std::vector<int>& cost) {
+        const char* c = line.data();
+        const char* end = c + line.size();
+        depend.clear();
+        cost.clear();
+        if (!ReadRecord(c, end, id, time, depend, &cost)) {
+            return false;
+        }
+        SkipBlanks(c, end);
+        return c == end;
+    }
+
+    struct Process {
+        int processID;
+        int execution_time;
+        int depend_offset;
+        int depend_count;
+    };
+    struct Graph {
+        std::vector<Process> process_vec;
+        std::vector<int> adjacency;
+    };
+
+    LoadStatus Load(const std::string& contents, Graph& g, std::vector<int>& cost) {
+        std::string file = testing::TempDir() + "GraphInput_unittests.txt";
+        FILE* out = fopen(file.c_str(), "wb");
+        fwrite(contents.data(), 1, contents.size(), out);
+        fclose(out);
+        std::string text;
+        LoadStatus status = LoadGraph(file, text, g, &cost);
+        remove(file.c_str());
+        return status;
+    }
+}
+
+TEST(GraphInput, reads_a_record) {
+    int id, time;
+    std::vector<int> depend, cost;
+    EXPECT_TRUE(ReadLine(" 4 7 { 1 , 2:5,3 }\r", id, time, depend, cost));
+    EXPECT_EQ(4, id);
+    EXPECT_EQ(7, time);
+    EXPECT_EQ((std::vector<int>{1, 2, 3}), depend);
+    EXPECT_EQ((std::vector<int>{0, 5, 0}), cost);
+    EXPECT_TRUE(ReadLine("1 0 {}", id, time, depend, cost));
+    EXPECT_TRUE(depend.empty());
+}
+
+TEST(GraphInput, rejects_malformed_and_negative_records) {
+    int id, time;
+    std::vector<int> depend, cost;
+    EXPECT_FALSE(ReadLine("2 -4 {1}", id, time, depend, cost));
+    EXPECT_FALSE(ReadLine("2 4 {1:-2}", id, time, depend, cost));
+    EXPECT_FALSE(ReadLine("2 4 {1", id, time, depend, cost));
+    EXPECT_FALSE(ReadLine("2 4 1}", id, time, depend, cost));
+    EXPECT_FALSE(ReadLine("2 4 {1,}", id, time, depend, cost));
+    EXPECT_FALSE(ReadLine("2 4 {1:}", id, time, depend, cost));
+    EXPECT_FALSE(ReadLine("2 99999999999 {}", id, time, depend, cost));
+    EXPECT_FALSE(ReadLine("2 4 {1} 3", id, time, depend, cost));
+    EXPECT_FALSE(ReadLine("hello world", id, time, depend, cost));
+}
+
+TEST(GraphInput, loads_a_file_by_the_same_rules) {
+    Graph g;
+    std::vector<int> cost;
+    ASSERT_EQ(LoadStatus::ok, Load("3\n1 3 {}\n2 4 {1:2}\n3 1 {1,2}\n", g, cost));
+    ASSERT_EQ(3u, g.process_vec.size());
+    EXPECT_EQ(1, g.process_vec[1].depend_count);
+    EXPECT_EQ(1, g.process_vec[2].depend_offset);
+    EXPECT_EQ((std::vector<int>{1, 1, 2}), g.adjacency);
+    EXPECT_EQ((std::vector<int>{2, 0, 0}), cost);
+
+    EXPECT_EQ(LoadStatus::malformed, Load("2\n1 3 {}\n2 -4 {1}\n", g, cost));
+    EXPECT_EQ(LoadStatus::malformed, Load("2\n1 3 {}\n2 4 {1:-2}\n", g, cost));
+    EXPECT_EQ(LoadStatus::malformed, Load("2\n1 3 {}\n3 4 {1}\n", g, cost));
+    EXPECT_EQ(LoadStatus::malformed, Load("2\n1 3 {}\n2 4 {5}\n", g, cost));
+    EXPECT_EQ(LoadStatus::malformed, Load("3\n1 3 {}\n2 4 {1}\n", g, cost));
+    EXPECT_EQ(LoadStatus::ok, Load("0\n", g, cost));
+    EXPECT_TRUE(g.process_vec.empty());
+}
@@ -15,6 +15,11 @@
 #include <string>
 #include <stack>
 #include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include "GraphInput.h"
 using namespace std;
 enum Color{ White, Gray, Black};
 struct Process {
@@ -22,8 +27,11 @@ struct Process {
     int execution_time;
     int start;
     int finish;
-    vector<int> depend_list;
-    vector<int> adj_list;
+    //where the dependency and dependent IDs are in Graph::adjacency
+    int depend_offset;
+    int depend_count;
+    int adj_offset;
+    int adj_count;
     Color color;
     int d;
     int f;
@@ -39,26 +47,44 @@ struct CompareFinish{
     }
 };
 
+/*
+ * adjacency holds every process's dependencies, then every process's
+ * dependents, one run per process. LoadGraph (GraphInput.h) appends the
+ * dependencies and ConstructGraph counts and fills in the dependents.
+ */
 struct Graph {
     int vertex_number;
     vector<Process> process_vec;
+    vector<int> adjacency;
 };
 
-void DFS_Visit(Graph& g, Process& u, int& time, bool& has_cycle, stack<Process>& Stack) {
+//with its own stack of (process, dependents visited so far), so long chains can't overflow the call stack
+void DFS_Visit(Graph& g, Process& root, int& time, bool& has_cycle, stack<Process>& Stack) {
+    vector<pair<Process*, int> > frames{make_pair(&root, 0)};
     ++time;
-    u.d = time;
-    u.color = Gray;
-    for (auto i : u.adj_list) {
-        if (g.process_vec[i - 1].color == White) {
-            DFS_Visit(g, g.process_vec[i - 1], time, has_cycle, Stack);
-        } else if (g.process_vec[i - 1].color == Gray) {
-            has_cycle = true;
+    root.d = time;
+    root.color = Gray;
+    while (!frames.empty()) {
+        Process& u = *frames.back().first;
+        if (frames.back().second < u.adj_count) {
+            int i = g.adjacency[u.adj_offset + frames.back().second++];
+            Process& v = g.process_vec[i - 1];
+            if (v.color == White) {
+                ++time;
+                v.d = time;
+                v.color = Gray;
+                frames.push_back(make_pair(&v, 0));
+            } else if (v.color == Gray) {
+                has_cycle = true;
+            }
+        } else {
+            u.color = Black;
+            ++time;
+            u.f = time;
+            Stack.push(u);
+            frames.pop_back();
         }
     }
-    u.color = Black;
-    ++time;
-    u.f = time;
-    Stack.push(u);
 }
 bool DFS(Graph& g, stack<Process>& Stack) {
     bool has_cycle = false;
@@ -74,9 +100,24 @@ bool DFS(Graph& g, stack<Process>& Stack) {
     return has_cycle;
 }
 void ConstructGraph(Graph& g) {
-    for (auto i : g.process_vec) {
-        for (auto j : i.depend_list) {
-            g.process_vec[j - 1].adj_list.push_back(i.processID);
+    int dependencies = (int)g.adjacency.size();
+    for (auto &i : g.process_vec) {
+        i.adj_count = 0;
+    }
+    for (int k = 0; k < dependencies; ++k) {
+        ++g.process_vec[g.adjacency[k] - 1].adj_count;
+    }
+    int offset = dependencies;
+    for (auto &i : g.process_vec) {
+        i.adj_offset = offset;
+        offset += i.adj_count;
+        i.adj_count = 0;
+    }
+    g.adjacency.resize(offset);
+    for (auto &i : g.process_vec) {
+        for (int k = i.depend_offset; k < i.depend_offset + i.depend_count; ++k) {
+            Process& v = g.process_vec[g.adjacency[k] - 1];
+            g.adjacency[v.adj_offset + v.adj_count++] = i.processID;
         }
     }
     for (auto &i : g.process_vec) {
@@ -90,7 +131,8 @@ bool LongestPath(Graph& g) {
     while (!Stack.empty()) {
         auto u = Stack.top();
         Stack.pop();
-        for (auto i : u.adj_list) {
+        for (int k = u.adj_offset; k < u.adj_offset + u.adj_count; ++k) {
+            int i = g.adjacency[k];
             if(g.process_vec[i - 1].start < g.process_vec[u.processID - 1].start
                + g.process_vec[u.processID - 1].execution_time) {
                 g.process_vec[i - 1].start = g.process_vec[u.processID - 1].start
@@ -103,35 +145,77 @@ bool LongestPath(Graph& g) {
     }
     return flag;
 }
-int main(int argc, const char * argv[]) {
-    ifstream fin1(argv[1]);
-    int process_number;
-    fin1 >> process_number;
-    Process p;
-    Graph g;
-    string s;
-    int number;
-    vector<Process> process_vec;
-    char garbage;
-    while (fin1 >> p.processID >> p.execution_time) {
-        vector<int> depend_list;
-        fin1 >> garbage;
-        while (fin1 >> number) {
-            char delimiter;
-            depend_list.push_back(number);
-            fin1 >> delimiter;
-            if (delimiter == '}') {
-                fin1.unget();
-                break;
+//one line of the --batch report
+struct BatchResult {
+    string file;
+    int processes = 0;
+    int tn = 0;
+    string status;
+};
+
+/*
+ * --batch: finds TN for every file on a pool of threads, then prints one
+ * CSV record per file, in order. Each thread keeps its text buffer and its
+ * Graph from one file to the next.
+ */
+int Batch(const string& path, unsigned threads) {
+    vector<string> files = BatchFiles(path);
+    vector<BatchResult> results(files.size());
+    atomic<size_t> next(0);
+    auto work = [&files, &results, &next](void) {
+        string text;
+        Graph g;
+        for (size_t k = next++; k < files.size(); k = next++) {
+            BatchResult& r = results[k];
+            r.file = files[k];
+            LoadStatus status = LoadGraph(files[k], text, g);
+            if (status != LoadStatus::ok) {
+                r.status = status == LoadStatus::unreadable ? "unreadable" : "malformed";
+                continue;
+            }
+            r.processes = (int)g.process_vec.size();
+            ConstructGraph(g);
+            if (LongestPath(g)) {
+                r.status = "cycle";
+                continue;
+            }
+            for (auto &i : g.process_vec) {
+                r.tn = max(r.tn, i.finish);
             }
+            r.status = "ok";
         }
-        if (fin1.fail()) {
-            fin1.clear();
+    };
+    vector<thread> pool;
+    for (unsigned t = 1; t < max(1u, threads); ++t) {
+        pool.emplace_back(work);
+    }
+    work();
+    for (auto &t : pool) {
+        t.join();
+    }
+    cout << "file,processes,TN,status\n";
+    for (auto &r : results) {
+        cout << r.file << "," << r.processes << "," << r.tn << "," << r.status << "\n";
+    }
+    cout.flush();
+    return 0;
+}
+
+//"--batch DIRECTORY|MANIFEST [--threads N]" does many files and prints a line for each
+int main(int argc, const char * argv[]) {
+    if (argc > 2 && string(argv[1]) == "--batch") {
+        unsigned threads = thread::hardware_concurrency();
+        if (argc > 4 && string(argv[3]) == "--threads") {
+            threads = (unsigned)atoi(argv[4]);
         }
-        fin1 >> garbage;
-        p.depend_list = depend_list;
-        process_vec.push_back(p);
-        g.process_vec = process_vec;
+        return Batch(argv[2], threads);
+    }
+    Graph g;
+    string text;
+    LoadStatus status = LoadGraph(argv[1], text, g);
+    if (status != LoadStatus::ok) {
+        cerr << (status == LoadStatus::unreadable ? "can't read " : "malformed input in ") << argv[1] << endl;
+        return 1;
     }
     ConstructGraph(g);
     bool has_cycle = LongestPath(g);
@@ -140,8 +224,9 @@ int main(int argc, const char * argv[]) {
         for (auto i : g.process_vec) {
             cout << "ID:" << i.processID << " StartTime:" << i.start << endl;
         }
+        //an empty file is a valid input too, with TN 0
         auto max_iterator = max_element(g.process_vec.begin(), g.process_vec.end(), CompareFinish());
-        cout << "TN is " << max_iterator->finish << endl;
+        cout << "TN is " << (max_iterator == g.process_vec.end() ? 0 : max_iterator->finish) << endl;
     } else {
         cout << "There is no feasible solution for given input." << endl;
     }
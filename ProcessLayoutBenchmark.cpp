@@ -0,0 +1,452 @@
+//
+//  ProcessLayoutBenchmark.cpp
+//  algorithm_proj3
+//
+//  Cache misses and times of the passes EE360CProject3's Process layout
+//  matters to, with the layout the scheduler has now and the one before the
+//  hot/cold split, on the same graph and adjacency arena:
+//
+//  - the cycle check's DFS, and Find_Path's weight walk from every process
+//    as each becomes a candidate, with the 40 byte Process and the DFS
+//    marks in their own Visit array, and with the 52 byte Process that had
+//    the marks in it
+//  - the candidate path: every ready process pushed on the ReadyQueue
+//    (ReadyQueue.h) once and popped once, with 12 byte Candidates in the
+//    4-ary queue, the same Candidates in a binary heap (std::priority_queue),
+//    and whole 52 byte Processes in the 4-ary queue, as the scheduler used
+//    to queue them
+//
+//  usage: ProcessLayoutBenchmark [processes] [repeats] [seed]
+//  defaults 1000000, 5 and 1. Counters come from perf_event_open; when the
+//  kernel won't give them (perf_event_paranoid, containers), only times are
+//  printed. There is no generic L2 event, so the second level reported is
+//  the last level cache.
+//
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <queue>
+#include <random>
+#include "ReadyQueue.h"
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+enum Color{ White, Gray, Black};
+
+//EE360CProject3's Process and Visit
+struct Process {
+    int processID;
+    int execution_time;
+    int start;
+    int finish;
+    int depend_offset;
+    int depend_count;
+    int adj_offset;
+    int adj_count;
+    int depend_weight;
+    int processorID;
+};
+struct Visit {
+    Color color;
+    int d;
+    int f;
+};
+
+//Process as it was before the split, the DFS marks in the middle
+struct WholeProcess {
+    int processID;
+    int execution_time;
+    int start;
+    int finish;
+    int depend_offset;
+    int depend_count;
+    int adj_offset;
+    int adj_count;
+    Color color;
+    int d;
+    int f;
+    int depend_weight;
+    int processorID;
+};
+
+//the split layout: the marks by ID - 1 beside the Processes
+struct SplitLayout {
+    vector<Process> process_vec;
+    vector<Visit> visit;
+    const Process& Record(int id) const { return process_vec[id - 1]; }
+    void ClearMarks(void) { visit.assign(process_vec.size(), Visit{White, 0, 0}); }
+    Color Mark(int id) const { return visit[id - 1].color; }
+    void Discover(int id, int time) { visit[id - 1] = Visit{Gray, time, 0}; }
+    void Finish(int id, int time) { visit[id - 1].color = Black; visit[id - 1].f = time; }
+    int Finished(int id) const { return visit[id - 1].f; }
+};
+
+//the old layout: the marks in the Processes
+struct WholeLayout {
+    vector<WholeProcess> process_vec;
+    const WholeProcess& Record(int id) const { return process_vec[id - 1]; }
+    void ClearMarks(void) {
+        for (auto &u : process_vec) {
+            u.color = White;
+            u.d = 0;
+            u.f = 0;
+        }
+    }
+    Color Mark(int id) const { return process_vec[id - 1].color; }
+    void Discover(int id, int time) { process_vec[id - 1].color = Gray; process_vec[id - 1].d = time; }
+    void Finish(int id, int time) { process_vec[id - 1].color = Black; process_vec[id - 1].f = time; }
+    int Finished(int id) const { return process_vec[id - 1].f; }
+};
+
+//for std::priority_queue, which pops the largest: CompareWeight's first is the largest
+struct AfterWeight{
+    bool operator()(const Candidate& left, const Candidate& right) const {
+        return CompareWeight()(right, left);
+    }
+};
+
+//std::priority_queue with ReadyQueue's reserve
+class BinaryHeap : public priority_queue<Candidate, vector<Candidate>, AfterWeight> {
+public:
+    void reserve(size_t n) { this->c.reserve(n); }
+};
+
+/*
+ * L1 data and last level read misses of whatever runs between Start and
+ * Stop, counted for this thread in user space only. Every counter is opened
+ * on its own, so one the CPU lacks only loses its own column.
+ */
+class CacheCounters {
+public:
+    static const int count = 2;
+    const char* names[count] = {"L1D read misses", "LLC read misses"};
+    long long values[count] = {-1, -1};  //-1 when the counter isn't available
+private:
+    int fd[count] = {-1, -1};
+public:
+    CacheCounters(void) {
+#ifdef __linux__
+        uint64_t configs[count] = {
+            PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+            PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)};
+        for (int k = 0; k < count; ++k) {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = configs[k];
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fd[k] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        }
+#endif
+    }
+    ~CacheCounters(void) {
+#ifdef __linux__
+        for (int k = 0; k < count; ++k) {
+            if (fd[k] >= 0) {
+                close(fd[k]);
+            }
+        }
+#endif
+    }
+    bool Available(void) {
+        return fd[0] >= 0 || fd[1] >= 0;
+    }
+    void Start(void) {
+#ifdef __linux__
+        for (int k = 0; k < count; ++k) {
+            if (fd[k] >= 0) {
+                ioctl(fd[k], PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd[k], PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+#endif
+    }
+    void Stop(void) {
+#ifdef __linux__
+        for (int k = 0; k < count; ++k) {
+            values[k] = -1;
+            long long value;
+            if (fd[k] >= 0) {
+                ioctl(fd[k], PERF_EVENT_IOC_DISABLE, 0);
+                if (read(fd[k], &value, sizeof(value)) == (ssize_t)sizeof(value)) {
+                    values[k] = value;
+                }
+            }
+        }
+#endif
+    }
+};
+
+//one kernel's best time and the counters of that run
+struct Measurement {
+    double seconds = 0;
+    long long misses[CacheCounters::count] = {-1, -1};
+};
+
+//runs setup then kernel repeats times, keeping the fastest run of kernel
+template <typename Setup, typename Kernel>
+Measurement Measure(CacheCounters& counters, int repeats, Setup setup, Kernel kernel) {
+    Measurement best;
+    for (int r = 0; r < repeats; ++r) {
+        setup();
+        auto begin = chrono::steady_clock::now();
+        counters.Start();
+        kernel();
+        counters.Stop();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+        if (r == 0 || seconds < best.seconds) {
+            best.seconds = seconds;
+            for (int k = 0; k < CacheCounters::count; ++k) {
+                best.misses[k] = counters.values[k];
+            }
+        }
+    }
+    return best;
+}
+
+void Report(const string& kernel, const string& layout, const Measurement& m, const CacheCounters& counters, size_t n) {
+    cout << kernel << " (" << layout << "): " << m.seconds * 1000 << " ms";
+    for (int k = 0; k < CacheCounters::count; ++k) {
+        if (m.misses[k] >= 0) {
+            cout << ", " << counters.names[k] << ":" << m.misses[k]
+                 << " (" << (double)m.misses[k] / n << " per process)";
+        }
+    }
+    cout << endl;
+}
+
+/*
+ * Graph::DFS, the cycle check, over either layout. Returns the finish
+ * times folded into one number, so the layouts can be checked against
+ * each other.
+ */
+template <typename Layout>
+uint64_t DFS(Layout& g, const vector<int>& adjacency, vector<pair<int, int> >& dfs_stack) {
+    g.ClearMarks();
+    int time = 0;
+    int n = (int)g.process_vec.size();
+    for (int root = 1; root <= n; ++root) {
+        if (g.Mark(root) != White) {
+            continue;
+        }
+        g.Discover(root, ++time);
+        dfs_stack.push_back(make_pair(root, 0));
+        while (!dfs_stack.empty()) {
+            const auto& u = g.Record(dfs_stack.back().first);
+            if (dfs_stack.back().second < u.adj_count) {
+                int i = adjacency[u.adj_offset + dfs_stack.back().second++];
+                if (g.Mark(i) == White) {
+                    g.Discover(i, ++time);
+                    dfs_stack.push_back(make_pair(i, 0));
+                }
+            } else {
+                g.Finish(u.processID, ++time);
+                dfs_stack.pop_back();
+            }
+        }
+    }
+    uint64_t order = 0;
+    for (int id = 1; id <= n; ++id) {
+        order = order * 31 + g.Finished(id);
+    }
+    return order;
+}
+
+//Graph::Find_Path from each of roots, over either layout; returns the weights' sum
+template <typename Layout>
+uint64_t Weights(const Layout& g, const vector<int>& adjacency, const vector<int>& roots,
+                 vector<int>& path_mark, int& path_stamp, vector<int>& to_visit) {
+    uint64_t total = 0;
+    for (auto root : roots) {
+        ++path_stamp;
+        to_visit.assign(1, root);
+        path_mark[root - 1] = path_stamp;
+        while (!to_visit.empty()) {
+            const auto& v = g.Record(to_visit.back());
+            to_visit.pop_back();
+            total += v.execution_time;
+            for (int k = v.adj_offset; k < v.adj_offset + v.adj_count; ++k) {
+                int i = adjacency[k];
+                if (path_mark[i - 1] != path_stamp) {
+                    path_mark[i - 1] = path_stamp;
+                    to_visit.push_back(i);
+                }
+            }
+        }
+    }
+    return total;
+}
+
+/*
+ * The two ways schedule() uses the queue: every process pushed, then all
+ * popped (a wide graph, everything ready at once), and a steady frontier
+ * of ready processes, one popped for each one pushed. Returns the popped
+ * IDs folded into one number, so the three queues can be checked against
+ * each other.
+ */
+template <typename Queue, typename T>
+uint64_t FillAndDrain(Queue& q, const vector<T>& items) {
+    uint64_t order = 0;
+    for (auto& i : items) {
+        q.push(i);
+    }
+    while (!q.empty()) {
+        order = order * 31 + q.top().processID;
+        q.pop();
+    }
+    return order;
+}
+template <typename Queue, typename T>
+uint64_t Steady(Queue& q, const vector<T>& items, size_t frontier) {
+    uint64_t order = 0;
+    for (size_t k = 0; k < items.size(); ++k) {
+        q.push(items[k]);
+        if (k >= frontier) {
+            order = order * 31 + q.top().processID;
+            q.pop();
+        }
+    }
+    while (!q.empty()) {
+        order = order * 31 + q.top().processID;
+        q.pop();
+    }
+    return order;
+}
+
+int main(int argc, const char * argv[]) {
+    size_t n = argc > 1 ? max<size_t>(1, (size_t)atoll(argv[1])) : 1000000;
+    int repeats = argc > 2 ? max(1, atoi(argv[2])) : 5;
+    unsigned seed = argc > 3 ? (unsigned)atoi(argv[3]) : 1;
+    const size_t frontier = 1024;
+
+    //n processes with up to two dependencies each, on earlier ones, in one
+    //arena as ConstructGraph builds it: the dependencies, then the dependents
+    mt19937 rng(seed);
+    SplitLayout split;
+    split.process_vec.resize(n);
+    vector<int> adjacency;
+    for (size_t k = 0; k < n; ++k) {
+        Process& p = split.process_vec[k];
+        p.processID = (int)k + 1;
+        p.execution_time = 1 + (int)(rng() % 20);
+        p.start = 0;
+        p.finish = p.execution_time;
+        p.depend_weight = (int)(rng() % 1000); //stands in for what Find_Path works out
+        p.processorID = 0;
+        p.depend_offset = (int)adjacency.size();
+        p.depend_count = k == 0 ? 0 : (int)(rng() % 3);
+        p.adj_count = 0;
+        for (int j = 0; j < p.depend_count; ++j) {
+            int id = 1 + (int)(rng() % k);
+            adjacency.push_back(id);
+            ++split.process_vec[id - 1].adj_count;
+        }
+    }
+    int offset = (int)adjacency.size();
+    for (auto &p : split.process_vec) {
+        p.adj_offset = offset;
+        offset += p.adj_count;
+        p.adj_count = 0;
+    }
+    adjacency.resize(offset);
+    for (auto &p : split.process_vec) {
+        for (int k = p.depend_offset; k < p.depend_offset + p.depend_count; ++k) {
+            Process& v = split.process_vec[adjacency[k] - 1];
+            adjacency[v.adj_offset + v.adj_count++] = p.processID;
+        }
+    }
+    WholeLayout whole;
+    vector<Candidate> thin(n);
+    for (auto &p : split.process_vec) {
+        whole.process_vec.push_back(WholeProcess{p.processID, p.execution_time, p.start, p.finish,
+            p.depend_offset, p.depend_count, p.adj_offset, p.adj_count, White, 0, 0, p.depend_weight, p.processorID});
+        thin[p.processID - 1] = Candidate{p.processID, p.execution_time, p.depend_weight};
+    }
+    //every process becomes a candidate once, and Find_Path weighs it then
+    vector<int> roots(n);
+    for (size_t k = 0; k < n; ++k) {
+        roots[k] = (int)k + 1;
+    }
+
+    CacheCounters counters;
+    cout << "The number of processes is:" << n << endl;
+    cout << "The size of a Process is:" << sizeof(Process) << " bytes plus a Visit of " << sizeof(Visit)
+         << ", it was:" << sizeof(WholeProcess) << ", a Candidate is:" << sizeof(Candidate) << endl;
+    if (!counters.Available()) {
+        cout << "No cache counters (perf_event_open refused), times only" << endl;
+    }
+
+    //the passes over the graph, with their buffers kept between runs as Graph keeps them
+    vector<pair<int, int> > dfs_stack;
+    vector<int> path_mark(n, 0), to_visit;
+    int path_stamp = 0;
+    uint64_t walks[2][2];
+    Measurement w[2][2];
+    auto nothing = [](void) {};
+    w[0][0] = Measure(counters, repeats, nothing, [&](void) { walks[0][0] = DFS(split, adjacency, dfs_stack); });
+    w[0][1] = Measure(counters, repeats, nothing, [&](void) { walks[0][1] = DFS(whole, adjacency, dfs_stack); });
+    w[1][0] = Measure(counters, repeats, nothing, [&](void) {
+        walks[1][0] = Weights(split, adjacency, roots, path_mark, path_stamp, to_visit); });
+    w[1][1] = Measure(counters, repeats, nothing, [&](void) {
+        walks[1][1] = Weights(whole, adjacency, roots, path_mark, path_stamp, to_visit); });
+
+    //a fresh queue for every run, with room for everything, so only push and pop are timed
+    uint64_t orders[2][3];
+    ReadyQueue ready;
+    BinaryHeap binary;
+    BasicReadyQueue<WholeProcess> whole_ready;
+    auto fresh = [&](void) {
+        ready = ReadyQueue();
+        ready.reserve(n);
+        binary = BinaryHeap();
+        binary.reserve(n);
+        whole_ready = BasicReadyQueue<WholeProcess>();
+        whole_ready.reserve(n);
+    };
+    Measurement m[2][3];
+    m[0][0] = Measure(counters, repeats, fresh, [&](void) { orders[0][0] = FillAndDrain(ready, thin); });
+    m[0][1] = Measure(counters, repeats, fresh, [&](void) { orders[0][1] = FillAndDrain(binary, thin); });
+    m[0][2] = Measure(counters, repeats, fresh, [&](void) { orders[0][2] = FillAndDrain(whole_ready, whole.process_vec); });
+    m[1][0] = Measure(counters, repeats, fresh, [&](void) { orders[1][0] = Steady(ready, thin, frontier); });
+    m[1][1] = Measure(counters, repeats, fresh, [&](void) { orders[1][1] = Steady(binary, thin, frontier); });
+    m[1][2] = Measure(counters, repeats, fresh, [&](void) { orders[1][2] = Steady(whole_ready, whole.process_vec, frontier); });
+
+    const char* passes[2] = {"DFS", "weights"};
+    const char* layouts[2] = {"Process and Visit", "Process with the marks"};
+    for (int k = 0; k < 2; ++k) {
+        for (int l = 0; l < 2; ++l) {
+            Report(passes[k], layouts[l], w[k][l], counters, n);
+        }
+        if (walks[k][0] != walks[k][1]) {
+            cerr << "the layouts disagree" << endl;
+            return 1;
+        }
+    }
+    const char* kernels[2] = {"fill and drain", "steady frontier of 1024"};
+    const char* queues[3] = {"Candidates, 4-ary", "Candidates, binary", "whole Processes, 4-ary"};
+    for (int k = 0; k < 2; ++k) {
+        for (int l = 0; l < 3; ++l) {
+            Report(kernels[k], queues[l], m[k][l], counters, n);
+        }
+        if (orders[k][0] != orders[k][1] || orders[k][0] != orders[k][2]) {
+            cerr << "the queues disagree" << endl;
+            return 1;
+        }
+    }
+    cout << "The checksum is:" << (walks[0][0] ^ walks[1][0] ^ orders[0][0] ^ orders[1][0]) << endl;
+    return 0;
+}
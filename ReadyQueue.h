@@ -0,0 +1,117 @@
+//
+//  ReadyQueue.h
+//  algorithm_proj3
+//
+//  EE360CProject3's candidate queue: the ready processes, the next one to
+//  schedule on top. ProcessLayoutBenchmark times the same queue, so both
+//  include it from here.
+//
+
+#ifndef _ReadyQueue_h
+#define _ReadyQueue_h
+
+#include <cstddef>
+#include <vector>
+
+//a ready process, with just what the candidate order looks at
+struct Candidate {
+    int processID;
+    int execution_time;
+    int depend_weight;
+};
+
+/*
+ * Heavier depend_weight first, then longer execution time, then lower ID.
+ * The original compared execution times with >=, which isn't a strict weak
+ * ordering: candidates tied on both came out in whatever order sort left
+ * them (reversed on every tick for short lists), and long lists could make
+ * sort run off the end. Ties are broken by ID instead, so a schedule can
+ * differ from the original's where two candidates tie. Any record with
+ * those three fields can be ordered, not only a Candidate.
+ */
+struct CompareWeight{
+    template <typename T>
+    bool operator()(const T& left, const T& right) const {
+        if (left.depend_weight > right.depend_weight) {
+            return true;
+        } else if (left.depend_weight == right.depend_weight) {
+            if (left.execution_time != right.execution_time) {
+                return left.execution_time > right.execution_time;
+            } else {
+                return left.processID < right.processID;
+            }
+        } else {
+            return false;
+        }
+    }
+};
+
+struct CompareID{
+    template <typename T>
+    bool operator()(const T& left, const T& right) const {
+        return left.processID < right.processID;
+    }
+};
+
+/*
+ * The candidates, first to schedule on top: CompareWeight order, or
+ * CompareID order for the baseline. A 4-ary heap, so push and pop are
+ * O(log n) and a sift touches about half the levels a binary heap does.
+ * The scheduler keeps Candidates; the element type is open so the
+ * benchmark can put bigger records through the same heap.
+ */
+template <typename T>
+class BasicReadyQueue {
+public:
+    bool by_id = false;
+private:
+    static const int arity = 4;
+    std::vector<T> heap = std::vector<T>{};
+    bool Before(const T& a, const T& b) const {
+        return by_id ? CompareID()(a, b) : CompareWeight()(a, b);
+    }
+public:
+    bool empty(void) const { return heap.empty(); }
+    size_t size(void) const { return heap.size(); }
+    const T& top(void) const { return heap[0]; }
+    void clear(void) { heap.clear(); }
+    void reserve(size_t n) { heap.reserve(n); }
+    void push(const T& c) {
+        size_t k = heap.size();
+        heap.push_back(c);
+        while (k > 0 && Before(c, heap[(k - 1) / arity])) {
+            heap[k] = heap[(k - 1) / arity];
+            k = (k - 1) / arity;
+        }
+        heap[k] = c;
+    }
+    void pop(void) {
+        T last = heap.back();
+        heap.pop_back();
+        size_t n = heap.size(), k = 0;
+        if (n == 0) {
+            return;
+        }
+        while (true) {
+            size_t first = k * arity + 1, child = first;
+            if (first >= n) {
+                break;
+            }
+            for (size_t j = first + 1; j < first + arity && j < n; ++j) {
+                if (Before(heap[j], heap[child])) {
+                    child = j;
+                }
+            }
+            if (!Before(heap[child], last)) {
+                break;
+            }
+            heap[k] = heap[child];
+            k = child;
+        }
+        heap[k] = last;
+    }
+};
+
+typedef BasicReadyQueue<Candidate> ReadyQueue;
+
+#endif